@@ -0,0 +1,316 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Comparison runner for the C implementation.
+//   c99_runner run <vectors> [seconds=1]  -- check and time against golden vectors, print JSON results
+//   c99_runner generate [count=240]       -- write a new set of golden vectors to stdout
+//
+// MultiCode.c is included so that ALLOCATE can be counted.
+
+static long long cr_allocations = 0;
+static long long cr_allocatedBytes = 0;
+
+static void* cr_Allocate(size_t count, size_t size) {
+    cr_allocations++;
+    cr_allocatedBytes += (long long)(count * size);
+    return calloc(count, size);
+}
+
+#define ALLOCATE cr_Allocate
+#define FREE free
+#include "../c99/MultiCode.c"
+
+#define CR_MAX_DATA 64
+#define CR_MAX_CODE 512
+
+/** One line of the vector file */
+typedef struct cr_Vector {
+    unsigned char data[CR_MAX_DATA];
+    int dataLength;
+    int sym;
+    char code[CR_MAX_CODE];
+    char input[CR_MAX_CODE];
+    unsigned char expect[CR_MAX_DATA];
+    int expectOk;
+} cr_Vector;
+
+#pragma region Vectors
+
+static int cr_HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/** Read hex into bytes. Returns byte count, or -1 if not valid hex */
+static int cr_ReadHex(const char* hex, unsigned char* out, int max) {
+    int length = (int)strlen(hex);
+    if (length % 2 != 0 || length / 2 > max) return -1;
+    for (int i = 0; i < length / 2; i++) {
+        int hi = cr_HexValue(hex[2 * i]);
+        int lo = cr_HexValue(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) return -1;
+        out[i] = (unsigned char)((hi << 4) | lo);
+    }
+    return length / 2;
+}
+
+static void cr_WriteHex(FILE* file, const unsigned char* data, int length) {
+    for (int i = 0; i < length; i++) fprintf(file, "%02X", data[i]);
+}
+
+/** Read tab-separated vectors: data hex, symbols, code, input, expected hex or '-'. Lines starting '#' are skipped */
+static cr_Vector* cr_ReadVectors(const char* path, int* count) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return NULL;
+
+    int capacity = 64;
+    cr_Vector* vectors = calloc((size_t)capacity, sizeof(cr_Vector));
+    *count = 0;
+
+    char line[4 * CR_MAX_CODE];
+    while (vectors != NULL && fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == '#' || line[0] == 0) continue;
+
+        char* fields[5];
+        int fieldCount = 0;
+        char* cursor   = line;
+        while (fieldCount < 5) {
+            fields[fieldCount++] = cursor;
+            char* tab = strchr(cursor, '\t');
+            if (tab == NULL) break;
+            *tab   = 0;
+            cursor = tab + 1;
+        }
+        if (fieldCount != 5) continue;
+
+        if (*count == capacity) {
+            capacity *= 2;
+            cr_Vector* grown = realloc(vectors, (size_t)capacity * sizeof(cr_Vector));
+            if (grown == NULL) break;
+            vectors = grown;
+        }
+
+        cr_Vector* v = &vectors[*count];
+        memset(v, 0, sizeof(*v));
+        v->dataLength = cr_ReadHex(fields[0], v->data, CR_MAX_DATA);
+        v->sym        = atoi(fields[1]);
+        if (v->dataLength < 1 || strlen(fields[2]) >= CR_MAX_CODE || strlen(fields[3]) >= CR_MAX_CODE) continue;
+        strcpy(v->code, fields[2]);
+        strcpy(v->input, fields[3]);
+        v->expectOk = strcmp(fields[4], "-") != 0;
+        if (v->expectOk && cr_ReadHex(fields[4], v->expect, CR_MAX_DATA) != v->dataLength) continue;
+        (*count)++;
+    }
+
+    fclose(file);
+    return vectors;
+}
+
+/** Small fixed generator, so the vector set is the same on every platform */
+static uint32_t cr_seed = 12345;
+
+static int cr_Random(int limit) {
+    cr_seed = cr_seed * 1103515245u + 12345u;
+    return (int)((cr_seed >> 8) % (uint32_t)limit);
+}
+
+/** Damage a code the way people do. Kind is 0 for none */
+static void cr_Damage(char* input, int kind) {
+    int length = (int)strlen(input);
+    int p      = cr_Random(length);
+    static const char* lookAlikes = "0O1I7LVUqO";
+
+    switch (kind) {
+        case 1: // transpose neighbours
+            if (p + 1 < length) {
+                char t = input[p];
+                input[p]     = input[p + 1];
+                input[p + 1] = t;
+            }
+            break;
+        case 2: // delete
+            memmove(input + p, input + p + 1, (size_t)(length - p));
+            break;
+        case 3: // insert
+            memmove(input + p + 1, input + p, (size_t)(length - p + 1));
+            input[p] = "0123456789ACDEFH"[cr_Random(16)];
+            break;
+        case 4: // substitute
+            input[p] = "0123456789ACDEFH"[cr_Random(16)];
+            break;
+        case 5: // look-alike
+            for (int i = 0; i < length; i++) {
+                const char* at = strchr(lookAlikes, input[(p + i) % length]);
+                if (at != NULL && (at - lookAlikes) % 2 == 0) {
+                    input[(p + i) % length] = at[1];
+                    break;
+                }
+            }
+            break;
+        case 6: // lower case, no separators
+        {
+            int j = 0;
+            for (int i = 0; i < length; i++) {
+                char c = input[i];
+                if (c == ' ' || c == '-') continue;
+                if (c >= 'A' && c <= 'Z') c = (char)(c + ('a' - 'A'));
+                input[j++] = c;
+            }
+            input[j] = 0;
+            break;
+        }
+        default: break;
+    }
+}
+
+static int cr_Generate(int count) {
+    printf("# Golden vectors for comparing MultiCode implementations.\n");
+    printf("# data-hex <tab> correction-symbols <tab> encoded <tab> decoder-input <tab> decoded-hex or '-' for failure\n");
+    printf("# Expected results are from the C implementation. Regenerate with: c99_runner generate\n");
+
+    // Fixed cases shared with the C# tests come first, then random data with each kind of damage
+    static const char* fixed[] = {"BC7DE6FD", "DA6C1DF2", "E137E76B", "BE006D89", "00000000", "FFFFFFFF"};
+    int fixedCount = (int)(sizeof(fixed) / sizeof(fixed[0]));
+
+    for (int i = 0; i < fixedCount + count; i++) {
+        unsigned char data[CR_MAX_DATA];
+        int dataLength, sym;
+        if (i < fixedCount) {
+            dataLength = cr_ReadHex(fixed[i], data, CR_MAX_DATA);
+            sym        = 6;
+        } else {
+            dataLength = 1 + cr_Random(16);
+            sym        = 2 + cr_Random(11);
+            for (int j = 0; j < dataLength; j++) data[j] = (unsigned char)cr_Random(256);
+        }
+
+        char* code = MultiCode_Encode(data, dataLength, sym);
+        if (code == NULL) return 1;
+
+        char input[CR_MAX_CODE];
+        strcpy(input, code);
+        if (i >= fixedCount) cr_Damage(input, (i - fixedCount) % 7);
+
+        char copy[CR_MAX_CODE];
+        strcpy(copy, input);
+        unsigned char* decoded = MultiCode_Decode(copy, dataLength, sym);
+
+        cr_WriteHex(stdout, data, dataLength);
+        printf("\t%d\t%s\t%s\t", sym, code, input);
+        if (decoded == NULL) printf("-");
+        else cr_WriteHex(stdout, decoded, dataLength);
+        printf("\n");
+
+        free(code);
+        free(decoded);
+    }
+    return 0;
+}
+
+#pragma endregion Vectors
+
+/** Decode with the allocating API, as other implementations do. Returns non-zero on success */
+static int cr_Decode(const cr_Vector* v, unsigned char* output) {
+    char copy[CR_MAX_CODE];
+    strcpy(copy, v->input);
+    unsigned char* decoded = MultiCode_Decode(copy, v->dataLength, v->sym);
+    if (decoded == NULL) return 0;
+    memcpy(output, decoded, (size_t)v->dataLength);
+    free(decoded);
+    return 1;
+}
+
+/** Decode into a caller buffer, with no allocation for clean codes */
+static int cr_DecodeInto(const cr_Vector* v, unsigned char* output) {
+    MultiCodeStatus status = MultiCode_DecodeInto(v->input, v->dataLength, v->sym, output);
+    return status == MultiCode_Clean || status == MultiCode_Corrected;
+}
+
+static void cr_Report(const char* name, const cr_Vector* vectors, int count, double seconds,
+                      int (*decode)(const cr_Vector*, unsigned char*)) {
+    int encodeMismatches = 0, decodeMismatches = 0;
+    char firstMismatch[CR_MAX_CODE * 2] = "";
+    unsigned char output[CR_MAX_DATA];
+
+    for (int i = 0; i < count; i++) {
+        const cr_Vector* v = &vectors[i];
+        char* code = MultiCode_Encode((void*)v->data, v->dataLength, v->sym);
+        if (code == NULL || strcmp(code, v->code) != 0) {
+            if (encodeMismatches++ == 0) snprintf(firstMismatch, sizeof(firstMismatch), "encode line %d", i + 1);
+        }
+        free(code);
+
+        int ok = decode(v, output);
+        if (ok != v->expectOk || (ok && memcmp(output, v->expect, (size_t)v->dataLength) != 0)) {
+            if (decodeMismatches++ == 0 && encodeMismatches == 0) {
+                snprintf(firstMismatch, sizeof(firstMismatch), "decode line %d", i + 1);
+            }
+        }
+    }
+
+    long long limit = (long long)(seconds * 1e9);
+
+    long long encodes = 0;
+    long long allocations = cr_allocations, bytes = cr_allocatedBytes;
+    long long start = MultiCode_MonotonicNanos();
+    while (MultiCode_MonotonicNanos() - start < limit) {
+        for (int i = 0; i < count; i++) free(MultiCode_Encode((void*)vectors[i].data, vectors[i].dataLength, vectors[i].sym));
+        encodes += count;
+    }
+    double encodeSeconds   = (MultiCode_MonotonicNanos() - start) / 1e9;
+    double encodeAllocs    = (double)(cr_allocations - allocations) / (double)encodes;
+    double encodeBytes     = (double)(cr_allocatedBytes - bytes) / (double)encodes;
+
+    long long decodes = 0;
+    allocations = cr_allocations;
+    bytes       = cr_allocatedBytes;
+    start       = MultiCode_MonotonicNanos();
+    while (MultiCode_MonotonicNanos() - start < limit) {
+        for (int i = 0; i < count; i++) decode(&vectors[i], output);
+        decodes += count;
+    }
+    double decodeSeconds = (MultiCode_MonotonicNanos() - start) / 1e9;
+    double decodeAllocs  = (double)(cr_allocations - allocations) / (double)decodes;
+    double decodeBytes   = (double)(cr_allocatedBytes - bytes) / (double)decodes;
+
+    printf("{\"impl\": \"%s\", \"vectors\": %d, \"encode_ops_per_sec\": %.0f, \"decode_ops_per_sec\": %.0f, "
+           "\"encode_allocs_per_op\": %.2f, \"decode_allocs_per_op\": %.2f, "
+           "\"encode_bytes_per_op\": %.0f, \"decode_bytes_per_op\": %.0f, "
+           "\"encode_mismatches\": %d, \"decode_mismatches\": %d, \"first_mismatch\": \"%s\"}\n",
+           name, count, encodes / encodeSeconds, decodes / decodeSeconds,
+           encodeAllocs, decodeAllocs, encodeBytes, decodeBytes,
+           encodeMismatches, decodeMismatches, firstMismatch);
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "generate") == 0) {
+        return cr_Generate(argc > 2 ? atoi(argv[2]) : 240);
+    }
+
+    if (argc < 3 || strcmp(argv[1], "run") != 0) {
+        printf("Usage: %s run <vectors> [seconds=1]\n       %s generate [count=240]\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    int count = 0;
+    cr_Vector* vectors = cr_ReadVectors(argv[2], &count);
+    if (vectors == NULL || count < 1) {
+        printf("Can't read vectors from %s\n", argv[2]);
+        return 1;
+    }
+
+    double seconds = argc > 3 ? atof(argv[3]) : 1.0;
+    cr_Report("c99", vectors, count, seconds, cr_Decode);
+    cr_Report("c99-into", vectors, count, seconds, cr_DecodeInto);
+
+    free(vectors);
+    return 0;
+}
@@ -0,0 +1,144 @@
+"""
+Run every available MultiCode implementation against the same golden vectors,
+and report throughput, allocations and any results that differ.
+
+    python3 bench/compare.py [--seconds 1] [--only c99,python] [--json] [--fail-on-mismatch]
+    python3 bench/compare.py --regenerate     # rebuild vectors.txt from the C implementation
+
+Implementations whose toolchain is not installed are skipped.
+"""
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+
+BENCH = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(BENCH)
+BUILD = os.path.join(BENCH, 'build')
+VECTORS = os.path.join(BENCH, 'vectors.txt')
+
+
+class Skip(Exception):
+    """ Implementation can't be run here """
+
+
+def find_tool(*names):
+    for name in names:
+        path = shutil.which(name)
+        if path is not None:
+            return path
+    raise Skip(f'needs {" or ".join(names)}')
+
+
+def build_c99():
+    compiler = find_tool(os.environ.get('CC', 'cc'), 'gcc', 'clang')
+    os.makedirs(BUILD, exist_ok=True)
+    runner = os.path.join(BUILD, 'c99_runner')
+    subprocess.run([compiler, '-std=gnu99', '-O2', '-o', runner, os.path.join(BENCH, 'c99_runner.c')], check=True)
+    return runner
+
+
+def run_c99(seconds):
+    return [build_c99(), 'run', VECTORS, str(seconds)], None
+
+
+def run_python(seconds):
+    return [sys.executable, os.path.join(BENCH, 'python_runner.py'), VECTORS, str(seconds)], None
+
+
+def run_go(seconds):
+    return [find_tool('go'), 'run', './cmd/compare', VECTORS, str(seconds)], os.path.join(ROOT, 'go', 'multicode')
+
+
+def run_csharp(seconds):
+    project = os.path.join(ROOT, 'csharp', 'MultiCode', 'MultiCodeCompare')
+    return [find_tool('dotnet'), 'run', '-c', 'Release', '--project', project, '--', VECTORS, str(seconds)], None
+
+
+def run_java(seconds):
+    javac = find_tool('javac')
+    java = find_tool('java')
+    core = os.path.join(ROOT, 'java', 'app', 'src', 'main', 'java', 'com', 'ieb', 'multicode_demo', 'core')
+    sources = [os.path.join(core, name) for name in sorted(os.listdir(core)) if name.endswith('.java')]
+    classes = os.path.join(BUILD, 'java')
+    subprocess.run([javac, '-d', classes, os.path.join(BENCH, 'java', 'MultiCodeCompare.java')] + sources, check=True)
+    return [java, '-cp', classes, 'MultiCodeCompare', VECTORS, str(seconds)], None
+
+
+def run_js(seconds):
+    raise Skip('js/ is a browser demo for fixed-length ID codes, with no library entry point')
+
+
+IMPLEMENTATIONS = {
+    'c99': run_c99,
+    'python': run_python,
+    'go': run_go,
+    'csharp': run_csharp,
+    'java': run_java,
+    'js': run_js,
+}
+
+
+def run(name, seconds):
+    """ Run one implementation. Returns a list of result dictionaries """
+    command, cwd = IMPLEMENTATIONS[name](seconds)
+    output = subprocess.run(command, cwd=cwd, check=True, capture_output=True, text=True).stdout
+    return [json.loads(line) for line in output.splitlines() if line.startswith('{')]
+
+
+def show(value, scale=1.0, digits=0):
+    if value is None:
+        return '-'
+    return f'{value / scale:,.{digits}f}'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare MultiCode implementations')
+    parser.add_argument('--seconds', type=float, default=1.0, help='time for each of encode and decode')
+    parser.add_argument('--only', help='comma-separated implementations to run')
+    parser.add_argument('--json', action='store_true', help='print raw results as JSON lines')
+    parser.add_argument('--fail-on-mismatch', action='store_true', help='exit with an error if any results differ')
+    parser.add_argument('--regenerate', action='store_true', help='rebuild vectors.txt from the C implementation')
+    args = parser.parse_args()
+
+    if args.regenerate:
+        vectors = subprocess.run([build_c99(), 'generate'], check=True, capture_output=True, text=True).stdout
+        with open(VECTORS, 'w', encoding='utf-8', newline='\n') as file:
+            file.write(vectors)
+        print(f'Wrote {VECTORS}')
+        return 0
+
+    names = args.only.split(',') if args.only else list(IMPLEMENTATIONS)
+    results = []
+    for name in names:
+        if name not in IMPLEMENTATIONS:
+            print(f'{name}: unknown implementation', file=sys.stderr)
+            return 1
+        try:
+            results += run(name, args.seconds)
+        except Skip as reason:
+            print(f'{name}: skipped, {reason}', file=sys.stderr)
+        except (subprocess.CalledProcessError, json.JSONDecodeError) as error:
+            print(f'{name}: failed, {error}', file=sys.stderr)
+
+    if args.json:
+        for result in results:
+            print(json.dumps(result))
+    else:
+        print(f'{"impl":<10} {"encode/s":>12} {"decode/s":>12} {"enc allocs":>10} {"dec allocs":>10} '
+              f'{"enc bytes":>10} {"dec bytes":>10} {"enc diff":>8} {"dec diff":>8} {"dec exc":>8}')
+        for r in results:
+            print(f'{r["impl"]:<10} {show(r["encode_ops_per_sec"]):>12} {show(r["decode_ops_per_sec"]):>12} '
+                  f'{show(r.get("encode_allocs_per_op"), digits=1):>10} {show(r.get("decode_allocs_per_op"), digits=1):>10} '
+                  f'{show(r.get("encode_bytes_per_op")):>10} {show(r.get("decode_bytes_per_op")):>10} '
+                  f'{r["encode_mismatches"]:>8} {r["decode_mismatches"]:>8} {r.get("decode_exceptions", 0):>8}'
+                  + (f'   first: {r["first_mismatch"]}' if r.get('first_mismatch') else ''))
+
+    mismatched = any(r['encode_mismatches'] or r['decode_mismatches'] for r in results)
+    return 1 if args.fail_on_mismatch and mismatched else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
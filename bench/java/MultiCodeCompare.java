@@ -0,0 +1,124 @@
+import com.ieb.multicode_demo.core.MultiCoder;
+
+import java.io.IOException;
+import java.lang.management.ManagementFactory;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Comparison runner for the Java implementation.
+ *   java MultiCodeCompare vectors [seconds=1]
+ * Prints one line of JSON results.
+ */
+public class MultiCodeCompare {
+
+    private record Vector(byte[] data, int sym, String code, String input, byte[] expect) {}
+
+    private static int exceptions = 0;
+
+    private static byte[] fromHex(String hex) {
+        var result = new byte[hex.length() / 2];
+        for (int i = 0; i < result.length; i++) {
+            result[i] = (byte) Integer.parseInt(hex.substring(2 * i, 2 * i + 2), 16);
+        }
+        return result;
+    }
+
+    /** Read tab-separated vectors: data hex, symbols, code, input, expected hex or '-' */
+    private static List<Vector> readVectors(String path) throws IOException {
+        var vectors = new ArrayList<Vector>();
+        for (var line : Files.readAllLines(Path.of(path), StandardCharsets.UTF_8)) {
+            if (line.isEmpty() || line.startsWith("#")) continue;
+            var fields = line.split("\t", -1);
+            if (fields.length != 5) continue;
+
+            var expect = fields[4].equals("-") ? null : fromHex(fields[4]);
+            vectors.add(new Vector(fromHex(fields[0]), Integer.parseInt(fields[1]), fields[2], fields[3], expect));
+        }
+        return vectors;
+    }
+
+    /** Decode a vector's input. Returns null on failure. Exceptions are counted as failures */
+    private static byte[] decode(Vector v) {
+        try {
+            var result = MultiCoder.Decode(v.input(), v.data().length, v.sym());
+            return result.length > 0 ? result : null;
+        } catch (RuntimeException e) {
+            exceptions++;
+            return null;
+        }
+    }
+
+    /** Bytes allocated by this thread so far, or -1 if the JVM can't tell */
+    private static long allocatedBytes() {
+        var bean = ManagementFactory.getThreadMXBean();
+        if (bean instanceof com.sun.management.ThreadMXBean sun) {
+            return sun.getThreadAllocatedBytes(Thread.currentThread().getId());
+        }
+        return -1;
+    }
+
+    public static void main(String[] args) throws IOException {
+        if (args.length < 1) {
+            System.out.println("Usage: MultiCodeCompare <vectors> [seconds=1]");
+            System.exit(1);
+        }
+
+        var vectors = readVectors(args[0]);
+        var seconds = args.length > 1 ? Double.parseDouble(args[1]) : 1.0;
+        if (vectors.isEmpty()) {
+            System.out.println("Can't read vectors from " + args[0]);
+            System.exit(1);
+        }
+
+        int encodeMismatches = 0, decodeMismatches = 0;
+        var firstMismatch = "";
+        for (int i = 0; i < vectors.size(); i++) {
+            var v = vectors.get(i);
+            if (!MultiCoder.Encode(v.data(), v.sym()).equals(v.code())) {
+                encodeMismatches++;
+                if (firstMismatch.isEmpty()) firstMismatch = "encode line " + (i + 1);
+            }
+            var got = decode(v);
+            if (!Arrays.equals(got, v.expect())) {
+                decodeMismatches++;
+                if (firstMismatch.isEmpty()) firstMismatch = "decode line " + (i + 1);
+            }
+        }
+        var decodeExceptions = exceptions;
+
+        var limit = (long) (seconds * 1e9);
+
+        long encodes = 0;
+        var bytesBefore = allocatedBytes();
+        var start = System.nanoTime();
+        while (System.nanoTime() - start < limit) {
+            for (var v : vectors) MultiCoder.Encode(v.data(), v.sym());
+            encodes += vectors.size();
+        }
+        var encodeRate = encodes / ((System.nanoTime() - start) / 1e9);
+        var encodeBytes = bytesBefore < 0 ? "null" : String.valueOf((allocatedBytes() - bytesBefore) / encodes);
+
+        long decodes = 0;
+        bytesBefore = allocatedBytes();
+        start = System.nanoTime();
+        while (System.nanoTime() - start < limit) {
+            for (var v : vectors) decode(v);
+            decodes += vectors.size();
+        }
+        var decodeRate = decodes / ((System.nanoTime() - start) / 1e9);
+        var decodeBytes = bytesBefore < 0 ? "null" : String.valueOf((allocatedBytes() - bytesBefore) / decodes);
+
+        System.out.printf("{\"impl\": \"java\", \"vectors\": %d, \"encode_ops_per_sec\": %.0f, \"decode_ops_per_sec\": %.0f, "
+                        + "\"encode_allocs_per_op\": null, \"decode_allocs_per_op\": null, "
+                        + "\"encode_bytes_per_op\": %s, \"decode_bytes_per_op\": %s, "
+                        + "\"encode_mismatches\": %d, \"decode_mismatches\": %d, \"decode_exceptions\": %d, "
+                        + "\"first_mismatch\": \"%s\"}%n",
+                vectors.size(), encodeRate, decodeRate, encodeBytes, decodeBytes,
+                encodeMismatches, decodeMismatches, decodeExceptions, firstMismatch);
+    }
+}
@@ -0,0 +1,95 @@
+"""
+Comparison runner for the Python implementation.
+    python3 python_runner.py <vectors> [seconds=1]
+Prints one line of JSON results. Allocations are not counted for Python.
+"""
+import json
+import os
+import sys
+import time
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'python', 'multi_code'))
+from multi_code import multi_code_encode, multi_code_decode  # noqa: E402
+
+
+def read_vectors(path: str):
+    """ Read tab-separated vectors: data hex, symbols, code, input, expected hex or '-' """
+    vectors = []
+    with open(path, encoding='utf-8') as file:
+        for line in file:
+            line = line.rstrip('\r\n')
+            if line == '' or line.startswith('#'):
+                continue
+            fields = line.split('\t')
+            if len(fields) != 5:
+                continue
+            expect = None if fields[4] == '-' else bytes.fromhex(fields[4])
+            vectors.append((bytes.fromhex(fields[0]), int(fields[1]), fields[2], fields[3], expect))
+    return vectors
+
+
+def decode(vector):
+    """ Decode a vector's input. Returns bytes, or None on failure. Exceptions are counted as failures """
+    global decode_errors
+    data, sym, _, code_input, _ = vector
+    try:
+        result = multi_code_decode(code_input, len(data), sym)
+    except Exception:
+        decode_errors += 1
+        return None
+    return bytes(result) if len(result) > 0 else None
+
+
+decode_errors = 0
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(f'Usage: {sys.argv[0]} <vectors> [seconds=1]')
+        return 1
+
+    vectors = read_vectors(sys.argv[1])
+    seconds = float(sys.argv[2]) if len(sys.argv) > 2 else 1.0
+
+    encode_mismatches = 0
+    decode_mismatches = 0
+    first_mismatch = ''
+    for i, vector in enumerate(vectors):
+        data, sym, code, _, expect = vector
+        if multi_code_encode(data, sym) != code:
+            encode_mismatches += 1
+            first_mismatch = first_mismatch or f'encode vector {i + 1}'
+        if decode(vector) != expect:
+            decode_mismatches += 1
+            first_mismatch = first_mismatch or f'decode vector {i + 1}'
+    errors = decode_errors
+
+    encodes = 0
+    start = time.perf_counter()
+    while time.perf_counter() - start < seconds:
+        for data, sym, _, _, _ in vectors:
+            multi_code_encode(data, sym)
+        encodes += len(vectors)
+    encode_rate = encodes / (time.perf_counter() - start)
+
+    decodes = 0
+    start = time.perf_counter()
+    while time.perf_counter() - start < seconds:
+        for vector in vectors:
+            decode(vector)
+        decodes += len(vectors)
+    decode_rate = decodes / (time.perf_counter() - start)
+
+    print(json.dumps({
+        'impl': 'python', 'vectors': len(vectors),
+        'encode_ops_per_sec': round(encode_rate), 'decode_ops_per_sec': round(decode_rate),
+        'encode_allocs_per_op': None, 'decode_allocs_per_op': None,
+        'encode_bytes_per_op': None, 'decode_bytes_per_op': None,
+        'encode_mismatches': encode_mismatches, 'decode_mismatches': decode_mismatches,
+        'decode_exceptions': errors, 'first_mismatch': first_mismatch,
+    }))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,9 +1,164 @@
 // ReSharper disable CppParameterMayBeConst
 // ReSharper disable CppLocalVariableMayBeConst
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include "MultiCode.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef MULTICODE_HISTOGRAMS
+#include <stdarg.h>
+#include <stdio.h>
+#endif
+
+#if defined(_MSC_VER)
+#define MC_THREAD_LOCAL __declspec(thread)
+#define MC_LOAD_ACQUIRE(p) (*(p))
+#define MC_STORE_RELEASE(p, v) (*(p) = (v))
+#define MC_COMPARE_SWAP(p, old, new) (InterlockedCompareExchange((p), (new), (old)) == (old))
+#define MC_LOAD_RELAXED(p) (*(p))
+#define MC_STORE_RELAXED(p, v) (*(p) = (v))
+#else
+#define MC_THREAD_LOCAL __thread
+#define MC_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define MC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define MC_COMPARE_SWAP(p, old, new) __sync_bool_compare_and_swap((p), (old), (new))
+#define MC_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define MC_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#endif
+
+/** State of shared look-up tables. These are built once, then only read */
+#define MC_TABLES_EMPTY 0
+#define MC_TABLES_BUILDING 1
+#define MC_TABLES_READY 2
+static volatile long mc_tablesState = MC_TABLES_EMPTY;
+void mc_BuildTables(void);
+
+/** Make sure shared look-up tables are ready. Safe to call from many threads at once */
+void mc_EnsureTables(void) {
+    if (MC_LOAD_ACQUIRE(&mc_tablesState) == MC_TABLES_READY) return;
+
+    if (MC_COMPARE_SWAP(&mc_tablesState, MC_TABLES_EMPTY, MC_TABLES_BUILDING)) {
+        mc_BuildTables();
+        MC_STORE_RELEASE(&mc_tablesState, MC_TABLES_READY);
+        return;
+    }
+
+    // Another thread is building the tables. This takes microseconds, so just wait.
+    while (MC_LOAD_ACQUIRE(&mc_tablesState) != MC_TABLES_READY) {}
+}
+
+#pragma region Scratch
+
+/** Number of block sizes kept by a scratch pool. Blocks are 32 bytes to 4KB, including header */
+#define MC_POOL_CLASSES 8
+
+/** Size of each slab of blocks taken from the heap */
+#define MC_POOL_SLAB 65536
+
+/** Re-usable scratch memory, owned by one context and used by one thread at a time */
+typedef struct mc_Pool {
+    void* freeLists[MC_POOL_CLASSES]; //!< released blocks of each size, ready for re-use
+    void* slabs;                      //!< every slab taken from the heap, linked through their first word
+    char* slabNext;                   //!< unused space in the current slab
+    size_t slabLeft;                  //!< bytes left at slabNext
+} mc_Pool;
+
+/** Header before every scratch allocation, so it can be returned to the right place */
+typedef union mc_ScratchHeader {
+    struct {
+        mc_Pool* pool; //!< owning pool, or NULL for heap allocations
+        int sizeClass; //!< free list the block belongs to
+    } owner;
+    long double alignment;
+} mc_ScratchHeader;
+
+/** Pool used for scratch allocations on this thread, if any */
+static MC_THREAD_LOCAL mc_Pool* mc_activePool = NULL;
+
+/**
+ * Allocate zeroed scratch memory. Uses the active context's pool if there is one, otherwise ALLOCATE.
+ * Release with mc_ScratchFree.
+ */
+void* mc_ScratchAllocate(size_t count, size_t size) {
+    if (count < 1 || size < 1 || count > ((size_t)-1 - sizeof(mc_ScratchHeader)) / size) return NULL;
+    size_t bytes = count * size + sizeof(mc_ScratchHeader);
+
+    mc_Pool* pool = mc_activePool;
+    int sizeClass = 0;
+    while (sizeClass < MC_POOL_CLASSES && ((size_t)32 << sizeClass) < bytes) sizeClass++;
+
+    mc_ScratchHeader* header;
+    if (pool == NULL || sizeClass >= MC_POOL_CLASSES) {
+        header = ALLOCATE(1, bytes);
+        if (header == NULL) return NULL;
+        header->owner.pool = NULL;
+    } else {
+        size_t blockSize = (size_t)32 << sizeClass;
+        if (pool->freeLists[sizeClass] != NULL) {
+            header = pool->freeLists[sizeClass];
+            pool->freeLists[sizeClass] = *(void**)header;
+        } else {
+            if (pool->slabLeft < blockSize) {
+                char* slab = ALLOCATE(1, MC_POOL_SLAB);
+                if (slab == NULL) return NULL;
+                *(void**)slab  = pool->slabs;
+                pool->slabs    = slab;
+                pool->slabNext = slab + sizeof(mc_ScratchHeader);
+                pool->slabLeft = MC_POOL_SLAB - sizeof(mc_ScratchHeader);
+            }
+            header = (mc_ScratchHeader*)pool->slabNext;
+            pool->slabNext += blockSize;
+            pool->slabLeft -= blockSize;
+        }
+
+        header->owner.pool = pool;
+        char* data = (char*)(header + 1);
+        for (size_t i = 0; i < bytes - sizeof(mc_ScratchHeader); i++) data[i] = 0;
+    }
+
+    header->owner.sizeClass = sizeClass;
+    return header + 1;
+}
+
+/** Release memory from mc_ScratchAllocate */
+void mc_ScratchFree(void* memory) {
+    if (memory == NULL) return;
+    mc_ScratchHeader* header = (mc_ScratchHeader*)memory - 1;
+    mc_Pool* pool = header->owner.pool;
+
+    if (pool == NULL) {
+        FREE(header);
+        return;
+    }
+
+    *(void**)header = pool->freeLists[header->owner.sizeClass];
+    pool->freeLists[header->owner.sizeClass] = header;
+}
+
+/** Release all memory held by a pool */
+void mc_PoolRelease(mc_Pool* pool) {
+    while (pool->slabs != NULL) {
+        void* next = *(void**)pool->slabs;
+        FREE(pool->slabs);
+        pool->slabs = next;
+    }
+    for (int i = 0; i < MC_POOL_CLASSES; i++) pool->freeLists[i] = NULL;
+    pool->slabNext = NULL;
+    pool->slabLeft = 0;
+}
+
+#pragma endregion Scratch
+
 #pragma region FlexArray
 
 /** A helper for cross-language variable-length integer arrays */
@@ -16,20 +171,20 @@ typedef struct FlexArrayObj {
 
 int* fa_ZeroArray(int size) {
     if (size < 1) return NULL;
-    int* result = ALLOCATE(size, sizeof(int));
+    int* result = mc_ScratchAllocate(size, sizeof(int));
     if (result == NULL) return NULL;
 
     return result;
 }
 
 FlexArray fa_Create(int length, const int storeSize) {
-    FlexArray result = ALLOCATE(1, sizeof(FlexArrayObj));
+    FlexArray result = mc_ScratchAllocate(1, sizeof(FlexArrayObj));
     if (result == NULL) {
         return NULL;
     }
     int* store = fa_ZeroArray(storeSize);
     if (store == NULL) {
-        FREE(result);
+        mc_ScratchFree(result);
         return NULL;
     }
 
@@ -80,6 +235,18 @@ int fa_AllZero(FlexArray this) {
     return 1;
 }
 
+/** Return <c>true</c> if both arrays hold the same values */
+int fa_Equal(FlexArray a, FlexArray b) {
+    if (a == NULL || b == NULL) return a == b;
+    if (a->_length != b->_length) return 0;
+
+    for (int i = 0; i < a->_length; i++) {
+        if (a->_storage[a->_offset + i] != b->_storage[b->_offset + i]) return 0;
+    }
+
+    return 1;
+}
+
 /** Data length of array */
 int fa_Length(FlexArray this) {
     if (this == NULL) return 0;
@@ -104,9 +271,9 @@ void fa_Release(FlexArray* reference) {
     FlexArray this = *reference;
     if (this == NULL) return;
     if (this->_storage != NULL)
-        FREE(this->_storage);
+        mc_ScratchFree(this->_storage);
     this->_storage = NULL;
-    FREE(this);
+    mc_ScratchFree(this);
     *reference = NULL;
 }
 
@@ -130,7 +297,7 @@ void fa_Grow(FlexArray* reference) {
         newStore[i] = this->_storage[i];
     }
 
-    FREE(this->_storage);
+    mc_ScratchFree(this->_storage);
     this->_storage = newStore;
 }
 
@@ -369,56 +536,39 @@ FlexArray fa_Pair(int a, int b) {
 #pragma region Galois16
 
 // 16-entry Galois field math for Reed-Solomon (4-bit per symbol)
-static int g16_created = 0;
-static int g16_exp[32];
-static int g16_log[16];
 const int g16_prime = 19; // must be fixed across implementations!
 
-/** Set up the look-up tables */
-void g16_CreateTables() {
-    g16_created = -1;
-    int x       = 1;
-
-    for (int i = 0; i < 16; i++) {
-        g16_exp[i] = x & 0x0f;
-        g16_log[x] = i & 0x0f;
-        x <<= 1;
-        if ((x & 0x110) != 0) x ^= g16_prime;
-    }
-    for (int i = 15; i < 32; i++) {
-        g16_exp[i] = g16_exp[i - 15] & 0x0f;
-    }
-}
+// Look-up tables are constant, so they are safe to share between threads.
+// g16_exp[i] is 2^i, reducing by g16_prime whenever bit 4 is set. It repeats every 15 entries.
+// g16_log is the inverse of g16_exp, with g16_log[0] unused.
+static const int g16_exp[32] = {1, 2, 4, 8, 3, 6, 12, 11, 5, 10, 7, 14, 15, 13, 9, 1,
+                                2, 4, 8, 3, 6, 12, 11, 5, 10, 7, 14, 15, 13, 9, 1, 2};
+static const int g16_log[16] = {0, 15, 1, 4, 2, 8, 5, 10, 3, 14, 9, 7, 6, 13, 11, 12};
 
 /** Add or Subtract: a +/- b */
 int g16_AddSub(int a, int b) {
-    if (!g16_created) g16_CreateTables();
     return (a ^ b) & 0x0f;
 }
 
 /** Multiply: a * b */
 int g16_Mul(int a, int b) {
-    if (!g16_created) g16_CreateTables();
     if (a == 0 || b == 0) return 0;
     return g16_exp[(g16_log[a] + g16_log[b]) % 15];
 }
 
 /** Divide: a / b */
 int g16_Div(int a, int b) {
-    if (!g16_created) g16_CreateTables();
     if (a == 0 || b == 0) return 0;
     return g16_exp[(g16_log[a] + 15 - g16_log[b]) % 15];
 }
 
 /** Power: n^p */
 int g16_Pow(int n, int p) {
-    if (!g16_created) g16_CreateTables();
     return g16_exp[(g16_log[n] * p) % 15];
 }
 
 /** Get multiplicative inverse: 1/n */
 int g16_Inverse(int n) {
-    if (!g16_created) g16_CreateTables();
     return g16_exp[15 - g16_log[n]];
 }
 
@@ -484,7 +634,7 @@ FlexArray g16_IrreduciblePoly(int symCount) {
     }
 
     for (int i = 0; i < symCount; i++) {
-        fa_Set(next, 1, g16_Pow(2, i));
+        fa_Set(next, 1, g16_exp[i % 15]); // 2^i
         FlexArray nextGen = g16_MulPoly(gen, next);
         fa_Release(&gen);
         if (nextGen == NULL) return NULL;
@@ -494,6 +644,59 @@ FlexArray g16_IrreduciblePoly(int symCount) {
     return gen;
 }
 
+/** Nybble lanes in a packed 64-bit word */
+#define G16_LANES 16
+#define G16_LOW_BITS 0x1111111111111111ULL
+
+/** Prepare the products of scalar 'sc' with each bit of a symbol, for g16_MulPacked */
+void g16_PackedFactors(int sc, uint64_t factors[4]) {
+    for (int b = 0; b < 4; b++) {
+        factors[b] = (uint64_t)g16_Mul(sc, 1 << b);
+    }
+}
+
+/**
+ * Multiply each of the 16 symbols packed into 'x' by a scalar, using factors from g16_PackedFactors.
+ * Multiplying by a constant is linear, so each bit of each symbol
+ * selects a fixed product, with no carries between lanes.
+ */
+uint64_t g16_MulPacked(uint64_t x, const uint64_t factors[4]) {
+    return (((x     ) & G16_LOW_BITS) * factors[0])
+         ^ (((x >> 1) & G16_LOW_BITS) * factors[1])
+         ^ (((x >> 2) & G16_LOW_BITS) * factors[2])
+         ^ (((x >> 3) & G16_LOW_BITS) * factors[3]);
+}
+
+/**
+ * Prepare masks for multiplying bit-sliced symbols by scalar 'sc', for g16_MulSlicedAdd.
+ * masks[r][b] is all ones if bit 'b' of the input contributes to bit 'r' of the product.
+ */
+void g16_SlicedFactors(int sc, uint64_t masks[4][4]) {
+    for (int b = 0; b < 4; b++) {
+        int product = g16_Mul(sc, 1 << b);
+        for (int r = 0; r < 4; r++) {
+            masks[r][b] = ((product >> r) & 1) ? ~0ULL : 0ULL;
+        }
+    }
+}
+
+/**
+ * Bit-sliced multiply and add: target += input * scalar, for 64 symbols at once.
+ * Each symbol is 4 words, where word 'b' holds bit 'b' of the symbol for all 64 lanes.
+ * The multiply is a fixed network of ANDs and XORs, with no table look-ups.
+ * @param target 4 words to add product to
+ * @param input 4 words to multiply
+ * @param masks scalar factors from g16_SlicedFactors
+ */
+void g16_MulSlicedAdd(uint64_t target[4], const uint64_t input[4], const uint64_t masks[4][4]) {
+    for (int r = 0; r < 4; r++) {
+        target[r] ^= (input[0] & masks[r][0])
+                   ^ (input[1] & masks[r][1])
+                   ^ (input[2] & masks[r][2])
+                   ^ (input[3] & masks[r][3]);
+    }
+}
+
 #pragma endregion Galois16
 
 #pragma region ReedSolomon
@@ -505,7 +708,7 @@ FlexArray rs_CalcSyndromes(FlexArray msg, int sym) {
     if (syndromes == NULL) return NULL;
 
     for (int i = 0; i < sym; i++) {
-        fa_Set(syndromes, i + 1, g16_EvalPoly(msg, g16_Pow(2, i)));
+        fa_Set(syndromes, i + 1, g16_EvalPoly(msg, g16_exp[i % 15])); // 2^i
     }
     return syndromes;
 }
@@ -560,7 +763,7 @@ FlexArray rs_FindErrors(FlexArray locPoly, int len) {
     if (pos == NULL) return NULL;
 
     for (int i = 0; i < len; i++) {
-        int test = g16_EvalPoly(locPoly, g16_Pow(2, i)) & 0x0f;
+        int test = g16_EvalPoly(locPoly, g16_exp[i % 15]) & 0x0f; // 2^i
         if (test == 0) {
             fa_Push(pos, len - 1 - i);
         }
@@ -612,9 +815,11 @@ FlexArray rs_ErrorEvaluator(FlexArray synd, FlexArray errLoc, int n) {
     FlexArray poly = g16_MulPoly(synd, errLoc);
     if (poly == NULL) return NULL;
 
-    int len = fa_Length(poly) - (n + 1);
+    // Positions past the end of the product read as zero, rather than past the end of its storage
+    int length = fa_Length(poly);
+    int len    = length - (n + 1);
     for (int i = 0; i < len; i++) {
-        fa_Set(poly, i, fa_Get(poly, i + len));
+        fa_Set(poly, i, i + len < length ? fa_Get(poly, i + len) : 0);
     }
 
     fa_TrimEnd(poly, len);
@@ -740,14 +945,112 @@ FlexArray rs_Encode(FlexArray msg, int sym)
     return output;
 }
 
+/** Largest correction symbol count for rs_EncodeBytes. Parity must fit in one 64-bit word */
+#define RS_PACKED_MAX_SYM 16
+
+/** Remainder tables for rs_EncodeBytes, by correction symbol count. Built with the other shared tables */
+static uint64_t rs_byteTables[RS_PACKED_MAX_SYM + 1][256];
+static int rs_byteTableBuilt[RS_PACKED_MAX_SYM + 1];
+
+/** Mask for 'sym' packed nybbles */
+uint64_t rs_PackedMask(int sym) {
+    return sym >= 16 ? ~0ULL : (1ULL << (4 * sym)) - 1;
+}
+
 /**
- * Main decode and correct function
- * @param msg input symbols
- * @param sym count of additional check symbols in input
- * @param expectedLength expected length of original input
- * @return decoded data, or NULL if can't be decoded
+ * Build the remainder table for 'sym' correction symbols.
+ * Entry 'b' is the parity of byte 'b' followed by 'sym' zero symbols, with the
+ * coefficient of x^i in nybble i. This is the same LFSR as rs_Encode, one symbol at a time.
  */
-FlexArray rs_Decode(FlexArray msg, int sym, int expectedLength)
+int rs_BuildByteTable(int sym) {
+    FlexArray gen = g16_IrreduciblePoly(sym);
+    if (gen == NULL) return 0;
+
+    // Generator without its leading 1, packed the same way as the parity
+    uint64_t packedGen = 0;
+    for (int j = 1; j <= sym; j++) packedGen |= (uint64_t)fa_Get(gen, j) << (4 * (sym - j));
+    fa_Release(&gen);
+
+    uint64_t mask = rs_PackedMask(sym);
+    int topShift  = 4 * (sym - 1);
+    for (int b = 0; b < 256; b++) {
+        uint64_t state = 0;
+        for (int half = 0; half < 2; half++) {
+            int symbol   = half == 0 ? (b >> 4) : (b & 0x0f);
+            int feedback = symbol ^ (int)(state >> topShift);
+
+            uint64_t factors[4];
+            g16_PackedFactors(feedback, factors);
+            state = ((state << 4) & mask) ^ g16_MulPacked(packedGen, factors);
+        }
+        rs_byteTables[sym][b] = state;
+    }
+
+    rs_byteTableBuilt[sym] = -1;
+    return -1;
+}
+
+/**
+ * Reed-Solomon parity of whole bytes, two symbols per step.
+ * This gives the same parity as rs_Encode, like a table-driven CRC.
+ * @param data bytes of message. Upper nybble of each byte is the first symbol.
+ * @param dataLength number of bytes
+ * @param sym number of correction symbols, from 2 to RS_PACKED_MAX_SYM
+ * @param parity receives parity symbols packed into nybbles, first symbol in nybble 'sym - 1'
+ * @return non-zero on success, or zero if 'sym' is out of range
+ */
+int rs_EncodeBytes(const unsigned char* data, int dataLength, int sym, uint64_t* parity) {
+    if (data == NULL || parity == NULL || sym < 2 || sym > RS_PACKED_MAX_SYM) return 0;
+    mc_EnsureTables();
+    if (!rs_byteTableBuilt[sym]) return 0;
+
+    const uint64_t* table = rs_byteTables[sym];
+    uint64_t mask  = rs_PackedMask(sym);
+    int topShift   = 4 * (sym - 2);
+    uint64_t state = 0;
+
+    // Shift two symbols out of the top, and fold them with the next byte back in
+    for (int i = 0; i < dataLength; i++) {
+        int index = (int)(state >> topShift) ^ data[i];
+        state     = ((state << 8) & mask) ^ table[index];
+    }
+
+    *parity = state;
+    return -1;
+}
+
+/**
+ * Reed-Solomon parity for 64 messages at once, in bit-sliced form.
+ * Each symbol is 4 words, where word 'b' holds bit 'b' of the symbol for all 64 messages.
+ * @param msg bit-sliced message symbols
+ * @param msgLength number of symbols in each message
+ * @param genMasks g16_SlicedFactors for generator polynomial terms 1..sym
+ * @param sym number of parity symbols
+ * @param parity receives bit-sliced parity symbols
+ */
+void rs_EncodeSliced(const uint64_t* msg, int msgLength, const uint64_t (*genMasks)[4][4], int sym, uint64_t* parity)
+{
+    for (int i = 0; i < sym * 4; i++) parity[i] = 0;
+    if (sym < 1) return;
+
+    for (int i = 0; i < msgLength; i++)
+    {
+        uint64_t feedback[4];
+        for (int b = 0; b < 4; b++) feedback[b] = msg[i * 4 + b] ^ parity[b];
+
+        // shift the remainder along one symbol
+        for (int j = 0; j < (sym - 1) * 4; j++) parity[j] = parity[j + 4];
+        for (int b = 0; b < 4; b++) parity[(sym - 1) * 4 + b] = 0;
+
+        for (int j = 0; j < sym; j++)
+        {
+            g16_MulSlicedAdd(parity + j * 4, feedback, (const uint64_t (*)[4])genMasks[j]);
+        }
+    }
+}
+
+/** Decode with Berlekamp-Massey, Chien search and Forney. Used where there is no syndrome table */
+FlexArray rs_DecodeAlgebraic(FlexArray msg, int sym, int expectedLength)
 {
     if (msg == NULL) return NULL;
 
@@ -799,10 +1102,232 @@ FlexArray rs_Decode(FlexArray msg, int sym, int expectedLength)
 
     // Error correction failed
     fa_Release(&synd2);
+    fa_Release(&result);
     return NULL;
 }
+/** Largest correction symbol count with a syndrome table: 16^6 entries is 128MB */
+#define RS_TABLE_MAX_SYM 6
+
+/** Longest code with a syndrome table. Error positions must fit in 6 bits */
+#define RS_TABLE_MAX_LENGTH 64
+
+/**
+ * Largest correction symbol count with a table built on first use. Builds take about 0.1s at 4 symbols,
+ * 1.6s at 5 and 25s at 6, so 6 symbol tables are only built when asked for
+ */
+#define RS_TABLE_LAZY_MAX_SYM 5
+
+/** Syndrome table entries: error count in bits 60-62, and 10 bits per error of position then value from bit 0 */
+#define RS_ENTRY_DECODABLE (1ULL << 63)
+#define RS_ENTRY_COUNT_SHIFT 60
+
+/** Tables for each code length and correction symbol count, published once built */
+static uint64_t* rs_syndromeTables[RS_TABLE_MAX_SYM + 1][RS_TABLE_MAX_LENGTH + 1];
+static volatile long rs_syndromeTableState[RS_TABLE_MAX_SYM + 1][RS_TABLE_MAX_LENGTH + 1];
+
+/** Memory syndrome tables may use, and memory they do use, in bytes. Zero limit turns tables off */
+static volatile long rs_syndromeTableLimit = 0;
+static volatile long rs_syndromeTableBytes = 0;
+
+/** State of a syndrome table that could not be built, or would not fit */
+#define RS_TABLE_FAILED 3
+
+/**
+ * Syndromes of a message, packed four bits each, first syndrome lowest.
+ * This is the index of the message in a syndrome table.
+ */
+int rs_SyndromeIndex(FlexArray msg, int sym) {
+    int index  = 0;
+    int length = fa_Length(msg);
+    for (int k = 0; k < sym; k++) {
+        // Horner's rule at 2^k. Log of 2^k is k, so we can skip the multiply
+        int s = 0;
+        for (int i = 0; i < length; i++) {
+            s = (s == 0 ? 0 : g16_exp[g16_log[s] + k]) ^ fa_Get(msg, i);
+        }
+        index |= s << (4 * k);
+    }
+    return index;
+}
+
+/** Bytes used by a syndrome table */
+long rs_SyndromeTableSize(int sym) {
+    return (long)sizeof(uint64_t) << (4 * sym);
+}
+
+/**
+ * Build a syndrome table by running the algebraic decoder once for each syndrome,
+ * so look-ups give exactly the same results, including the few corrections past half the symbol count.
+ * Messages that are zero except in their last 'sym' codes have every syndrome exactly once.
+ * The decoder's scratch memory comes from a pool of our own for the build, which saves about a third of the time.
+ */
+uint64_t* rs_BuildSyndromeTable(int length, int sym) {
+    uint64_t* table = ALLOCATE((size_t)1 << (4 * sym), sizeof(uint64_t));
+    FlexArray msg   = fa_Fixed(length);
+    if (table == NULL || msg == NULL) {
+        FREE(table);
+        fa_Release(&msg);
+        return NULL;
+    }
+
+    mc_Pool pool      = {0};
+    mc_Pool* previous = mc_activePool;
+    mc_activePool     = &pool;
+
+    for (int v = 0; v < (1 << (4 * sym)); v++) {
+        for (int k = 0; k < sym; k++) fa_Set(msg, length - 1 - k, (v >> (4 * k)) & 0x0f);
+
+        FlexArray corrected = rs_DecodeAlgebraic(msg, sym, length);
+        if (corrected == NULL) continue;
+
+        uint64_t entry = RS_ENTRY_DECODABLE;
+        int count      = 0;
+        for (int i = 0; i < length; i++) {
+            int error = fa_Get(corrected, i) ^ fa_Get(msg, i);
+            if (error == 0) continue;
+            entry |= (uint64_t)((i << 4) | error) << (10 * count++);
+        }
+        table[rs_SyndromeIndex(msg, sym)] = entry | ((uint64_t)count << RS_ENTRY_COUNT_SHIFT);
+        fa_Release(&corrected);
+    }
+
+    mc_activePool = previous;
+    mc_PoolRelease(&pool);
+    fa_Release(&msg);
+    return table;
+}
+
+/**
+ * Find the syndrome table for a code length and correction symbol count, building it if there is room.
+ * If another thread is building it, this doesn't wait.
+ * @param maxBuildSym largest correction symbol count to build a missing table for
+ * @return table, or NULL to use algebraic decoding
+ */
+const uint64_t* rs_SyndromeTable(int length, int sym, int maxBuildSym) {
+    if (sym < 1 || sym > RS_TABLE_MAX_SYM || length <= sym || length > RS_TABLE_MAX_LENGTH) return NULL;
+
+    volatile long* state = &rs_syndromeTableState[sym][length];
+    long current = MC_LOAD_ACQUIRE(state);
+    if (current == MC_TABLES_READY) return rs_syndromeTables[sym][length];
+    if (current != MC_TABLES_EMPTY || sym > maxBuildSym || MC_LOAD_ACQUIRE(&rs_syndromeTableLimit) == 0) return NULL;
+
+    // Reserve memory before building, so tables built at once on many threads stay in the limit
+    long size = rs_SyndromeTableSize(sym);
+    long used;
+    do {
+        used = MC_LOAD_ACQUIRE(&rs_syndromeTableBytes);
+        if (size > MC_LOAD_ACQUIRE(&rs_syndromeTableLimit) - used) return NULL;
+    } while (!MC_COMPARE_SWAP(&rs_syndromeTableBytes, used, used + size));
+
+    // Another thread may have got here first
+    uint64_t* table = NULL;
+    if (MC_COMPARE_SWAP(state, MC_TABLES_EMPTY, MC_TABLES_BUILDING)) {
+        table = rs_BuildSyndromeTable(length, sym);
+        rs_syndromeTables[sym][length] = table;
+        MC_STORE_RELEASE(state, table == NULL ? RS_TABLE_FAILED : MC_TABLES_READY);
+    }
+
+    if (table == NULL) { // give back the reservation
+        do {
+            used = MC_LOAD_ACQUIRE(&rs_syndromeTableBytes);
+        } while (!MC_COMPARE_SWAP(&rs_syndromeTableBytes, used, used - size));
+    }
+    return table;
+}
+
+/**
+ * Main decode and correct function.
+ * Uses syndrome table look-up, where a table fits the memory limit,
+ * otherwise the algebraic decoder. Results are the same either way.
+ * @param msg input symbols
+ * @param sym count of additional check symbols in input
+ * @param expectedLength expected length of original input
+ * @return decoded data, or NULL if can't be decoded
+ */
+FlexArray rs_Decode(FlexArray msg, int sym, int expectedLength)
+{
+    if (msg == NULL) return NULL;
+
+    const uint64_t* table = fa_Length(msg) == expectedLength ? rs_SyndromeTable(expectedLength, sym, RS_TABLE_LAZY_MAX_SYM) : NULL;
+    if (table == NULL) return rs_DecodeAlgebraic(msg, sym, expectedLength);
+
+    uint64_t entry = table[rs_SyndromeIndex(msg, sym)];
+    if ((entry & RS_ENTRY_DECODABLE) == 0) return NULL;
+
+    FlexArray result = fa_Copy(msg);
+    if (result == NULL) return NULL;
+
+    int count = (int)(entry >> RS_ENTRY_COUNT_SHIFT) & 7;
+    for (int k = 0; k < count; k++) {
+        int error    = (int)(entry >> (10 * k)) & 0x3ff;
+        int position = error >> 4;
+        fa_Set(result, position, fa_Get(result, position) ^ (error & 0x0f));
+    }
+    return result;
+}
+
 #pragma endregion ReedSolomon
 
+#pragma region Histograms
+#ifdef MULTICODE_HISTOGRAMS
+
+/** Histograms for one thread, linked into a list of all threads that have decoded */
+typedef struct mc_ThreadHistogram {
+    MultiCodeHistogram histogram;
+    struct mc_ThreadHistogram* next;
+} mc_ThreadHistogram;
+
+static mc_ThreadHistogram* volatile mc_allHistograms = NULL;
+static MC_THREAD_LOCAL mc_ThreadHistogram* mc_threadHistogram = NULL;
+
+/** Add a thread's histograms to the shared list, without locking */
+void mc_HistogramLink(mc_ThreadHistogram* item) {
+    mc_ThreadHistogram* head;
+    do {
+        head       = MC_LOAD_ACQUIRE(&mc_allHistograms);
+        item->next = head;
+#if defined(_MSC_VER)
+    } while (InterlockedCompareExchangePointer((PVOID volatile*)&mc_allHistograms, item, head) != head);
+#else
+    } while (!__sync_bool_compare_and_swap(&mc_allHistograms, head, item));
+#endif
+}
+
+/** Bucket for a duration. Four buckets per power of two, exact below 4ns */
+int mc_HistogramBucket(long long nanos) {
+    if (nanos < 4) return nanos < 0 ? 0 : (int)nanos;
+
+    int exponent = 2;
+    while (exponent < 63 && (nanos >> (exponent + 1)) != 0) exponent++;
+
+    int sub = (int)(nanos >> (exponent - 2)) & 3;
+    return (exponent - 1) * 4 + sub;
+}
+
+/** Record the duration of a decode phase for the current thread */
+void mc_HistogramRecord(MultiCodePhase phase, long long nanos) {
+    if (mc_threadHistogram == NULL) {
+        // Never freed: counts outlive the thread, so they are still in merged results
+        mc_threadHistogram = ALLOCATE(1, sizeof(mc_ThreadHistogram));
+        if (mc_threadHistogram == NULL) return;
+        mc_HistogramLink(mc_threadHistogram);
+    }
+    // Only this thread writes its counts, but MultiCode_HistogramMerge may read them at any time
+    unsigned long long* count = &mc_threadHistogram->histogram.counts[phase][mc_HistogramBucket(nanos)];
+    MC_STORE_RELAXED(count, MC_LOAD_RELAXED(count) + 1);
+}
+
+#define MC_PHASE_START(name) long long name = MultiCode_MonotonicNanos()
+#define MC_PHASE_END(phase, name) mc_HistogramRecord(phase, MultiCode_MonotonicNanos() - (name))
+
+#else
+
+#define MC_PHASE_START(name)
+#define MC_PHASE_END(phase, name)
+
+#endif
+#pragma endregion Histograms
+
 #pragma region MultiCoder
 
 #pragma region CodeParameters
@@ -842,6 +1367,20 @@ char mc_Correction(char inp) {
     }
 }
 
+/**
+ * Other likely meanings for characters changed by mc_Correction, most likely first.
+ * These are tried by look-alike decoding when the first guess doesn't fit.
+ */
+const char* mc_LookAlikes(char inp) {
+    switch (inp) {
+        case 'O': return "qD";
+        case 'L': return "7";
+        case 'I': return "J7";
+        case 'U': return "W";
+        default: return "";
+    }
+}
+
 /** Case changes to improve letter/number distinction */
 char mc_CaseChanges(char inp) {
     switch (inp) {
@@ -864,254 +1403,1007 @@ int mc_IndexOf(const char src[18], char target) {
     return -1;
 }
 
-/** Message value, and message output position to encoded character */
-char mc_EncodeDisplay(int number, int position) {
-    if (number < 0 || number > 15) return '~';
-    if ((position & 1) == 0) return OddSet[number];
-    return EvenSet[number];
-}
+/** Classification results for mc_Classify, in addition to symbol values */
+#define MC_SPACE  -1
+#define MC_BROKEN -2
+#define MC_DOUBLE -3
 
-/** Create an output string for message data. Result must be free()'d */
-char* mc_Display(FlexArray message) {
-    int length = 1; // space for terminator
-    for (int i = 0; i < fa_Length(message); i++) {
-        length++;
-        if (i > 0 && (i % 4 == 0 || i % 2 == 0)) length++;
-    }
+/** Upper-case an input character, with case changes for letter/number distinction */
+char mc_Normalise(char src) {
+    if (src >= 'a') src = (char)(src - ('a' - 'A'));
+    return mc_CaseChanges(src); // Q->q, S->s, B->b
+}
 
-    char* result = ALLOCATE(length, 1);
-    if (result == NULL) return NULL;
+/**
+ * Find symbol value of a normalised character.
+ * Returns symbol (0..15) with chirality in bit 4 (0 = odd set, 1 = even set),
+ * MC_BROKEN for characters in neither set, or MC_DOUBLE for characters in both sets.
+ */
+int mc_SymbolOf(char src) {
+    int oddIdx  = mc_IndexOf(OddSet, src);
+    int evenIdx = mc_IndexOf(EvenSet, src);
+
+    if (oddIdx < 0 && evenIdx < 0) return MC_BROKEN;
+    if (oddIdx >= 0 && evenIdx >= 0) return MC_DOUBLE;
+    if (oddIdx >= 0) return oddIdx;
+    return evenIdx | 0x10;
+}
 
-    int j = 0;
-    for (int i = 0; i < fa_Length(message); i++) {
-        if (i > 0) {
-            if (i % 4 == 0) result[j++] = '-';
-            else if (i % 2 == 0) result[j++] = ' ';
-        }
+/**
+ * Normalise an input character, and find its symbol value.
+ * Returns as for mc_SymbolOf, or MC_SPACE for separators.
+ */
+int mc_Classify(char src) {
+    if (mc_IsSpace(src)) return MC_SPACE;
 
-        result[j++] = mc_EncodeDisplay(fa_Get(message, i), i);
-    }
+    src = mc_Normalise(src);
+    src = mc_Correction(src); // fix for anticipated transcription errors
 
-    result[j] = 0; // ensure terminator
-    return result;
+    return mc_SymbolOf(src);
 }
 
-/** Find first position where chirality is incorrect */
-int mc_FindFirstChiralityError(FlexArray chirality) {
-    if (chirality == NULL) return -1;
+#pragma region Alphabets
 
-    for (int position = 0; position < fa_Length(chirality); position++) {
-        int expected = position & 1;
-        if (fa_Get(chirality, position) != expected) return position;
-    }
+/** Most meanings a look-alike character can have, including the first guess */
+#define MC_MAX_MEANINGS 4
 
-    return -1;
+/**
+ * Look-up tables for one alphabet. Every input character is classified with a
+ * single table read, so custom alphabets decode at the same speed as the built-in one.
+ */
+typedef struct MultiCodeAlphabetObj {
+    signed char classes[256];                   //!< as for mc_Classify, indexed by input character
+    signed char meanings[256][MC_MAX_MEANINGS]; //!< look-alike meanings, most likely first, as for mc_SymbolOf
+    unsigned char meaningCount[256];            //!< zero for characters that are not look-alikes
+    char pairs[256][2];                         //!< display characters for a symbol pair, indexed by (first << 4) | second
+    char odd[16];                               //!< display character for each symbol at an odd position
+    char even[16];                              //!< display character for each symbol at an even position
+} MultiCodeAlphabetObj;
+
+/** Tables for OddSet and EvenSet, built by mc_BuildTables */
+static MultiCodeAlphabetObj mc_builtinAlphabet;
+
+/** Alphabet used for encoding and decoding on this thread */
+static MC_THREAD_LOCAL const MultiCodeAlphabetObj* mc_activeAlphabet = &mc_builtinAlphabet;
+
+/** Fill in the display tables of an alphabet from its odd and even characters */
+void mc_AlphabetDisplayTables(MultiCodeAlphabetObj* alphabet) {
+    for (int i = 0; i < 256; i++) {
+        alphabet->pairs[i][0] = alphabet->odd[i >> 4];
+        alphabet->pairs[i][1] = alphabet->even[i & 0x0f];
+    }
 }
 
-/** Try to find and repair a single chirality error.
- * This is the core of the odd/even code repairs. */
-int mc_RepairCodesAndChirality(int expectedCodeLength,
-                               FlexArray codes, FlexArray chirality) {
-    const int tryAgain  = 0;
-    const int completed = -1;
-
-    if (codes == NULL || chirality == NULL) return completed;
-
-    if (fa_Length(codes) != fa_Length(chirality)) {
-        // ERROR in code/chirality code
-        return completed; // can't do much here
+/** Build tables for the built-in alphabet from mc_Classify and the look-alike lists */
+void mc_BuildBuiltinAlphabet(MultiCodeAlphabetObj* alphabet) {
+    for (int i = 0; i < 16; i++) {
+        alphabet->odd[i]  = OddSet[i];
+        alphabet->even[i] = EvenSet[i];
+    }
+    mc_AlphabetDisplayTables(alphabet);
+
+    for (int i = 0; i < 256; i++) {
+        alphabet->classes[i]      = (signed char)mc_Classify((char)i);
+        alphabet->meaningCount[i] = 0;
+        if (mc_IsSpace((char)i)) continue;
+
+        char normal = mc_Normalise((char)i);
+        char first  = mc_Correction(normal);
+        if (first == normal) continue; // not a look-alike
+
+        const char* others = mc_LookAlikes(normal);
+        int count = 0;
+        alphabet->meanings[i][count++] = (signed char)mc_SymbolOf(first);
+        for (int j = 0; others[j] != 0 && count < MC_MAX_MEANINGS; j++) {
+            alphabet->meanings[i][count++] = (signed char)mc_SymbolOf(others[j]);
+        }
+        alphabet->meaningCount[i] = (unsigned char)count;
     }
+}
 
-    int currentLength = fa_Length(codes);
-    int minLength     = (2 * expectedCodeLength) / 3;
+/** Other-case letter for an ASCII letter, or zero */
+char mc_OtherCase(char c) {
+    if (c >= 'a' && c <= 'z') return (char)(c - ('a' - 'A'));
+    if (c >= 'A' && c <= 'Z') return (char)(c + ('a' - 'A'));
+    return 0;
+}
+
+/**
+ * Check and add one set of display characters to a custom alphabet
+ * @return zero on success, -1 if the set is not 16 distinct printable characters unused by earlier sets
+ */
+int mc_AlphabetAddSet(MultiCodeAlphabetObj* alphabet, const char* set, char* display, int chirality) {
+    if (set == NULL) return -1;
+    for (int i = 0; i < 16; i++) {
+        unsigned char c = (unsigned char)set[i];
+        if (c <= ' ' || c >= 0x7f || alphabet->classes[c] != MC_BROKEN) return -1;
 
-    if (currentLength < minLength) {
-        // Code is too short to recover accurately
-        return completed;
+        alphabet->classes[c] = (signed char)(i | (chirality << 4));
+        display[i] = (char)c;
     }
+    return set[16] == 0 ? 0 : -1;
+}
 
-    int firstErrPos = mc_FindFirstChiralityError(chirality);
-    if (currentLength == expectedCodeLength && firstErrPos < 0) {
-        // Input codes seem correct
-        return completed;
+/**
+ * Check and build the tables for a custom alphabet
+ * @return zero on success, -1 if the definition is not valid
+ */
+int mc_BuildAlphabet(MultiCodeAlphabetObj* alphabet, const MultiCodeAlphabetDefinition* definition) {
+    for (int i = 0; i < 256; i++) alphabet->classes[i] = MC_BROKEN;
+
+    if (mc_AlphabetAddSet(alphabet, definition->oddSet, alphabet->odd, 0) < 0) return -1;
+    if (mc_AlphabetAddSet(alphabet, definition->evenSet, alphabet->even, 1) < 0) return -1;
+    mc_AlphabetDisplayTables(alphabet);
+
+    const char* separators = definition->separators != NULL ? definition->separators : " -._+*#";
+    for (int i = 0; separators[i] != 0; i++) {
+        unsigned char c = (unsigned char)separators[i];
+        if (alphabet->classes[c] != MC_BROKEN) return -1; // separator is also a symbol
+        alphabet->classes[c] = MC_SPACE;
     }
 
-    // If input is shorter than expected, guess where a deletion occurred, and insert a zero-value.
-    if (currentLength < expectedCodeLength) {
-        // Insert a zero value at error position, and inject correct chirality
-        if (firstErrPos < 0) {
-            // error is at the end
-            int chi  = currentLength & 1;
-            int endChi = expectedCodeLength & 1;
-            int diff = expectedCodeLength - currentLength;
-            if (diff == 1 && chi == endChi) {
-                // don't add a wrong chi at the end if we're off-by-one
-                fa_AddStart(codes, 0);
-                fa_AddStart(chirality, 0);
-            } else {
-                fa_Push(codes, 0);
-                fa_Push(chirality, chi);
-            }
-            return tryAgain;
+    // Look-alikes: the first meaning is used by normal decoding, and the rest by look-alike decoding
+    for (int k = 0; definition->lookAlikes != NULL && definition->lookAlikes[k] != NULL; k++) {
+        const char* entry = definition->lookAlikes[k];
+        unsigned char c   = (unsigned char)entry[0];
+        if (c == 0 || alphabet->classes[c] != MC_BROKEN || alphabet->meaningCount[c] != 0) return -1;
+
+        int count = 0;
+        for (int j = 1; entry[j] != 0; j++) {
+            int meaning = alphabet->classes[(unsigned char)entry[j]];
+            if (meaning < 0 || count >= MC_MAX_MEANINGS) return -1; // must be symbol characters
+            alphabet->meanings[c][count++] = (signed char)meaning;
         }
+        if (count < 1) return -1;
 
-        // error not at end
-        int chi     = firstErrPos & 1;
-        int chiNext = (firstErrPos+1) & 1;
-        int chi3rd  = (firstErrPos+2) & 1;
-        // First, check if this is a transpose and not the first delete
-        if (firstErrPos < currentLength - 3 // not near end
-            && fa_Get(chirality, firstErrPos) != chi // this position has wrong chirality
-            && fa_Get(chirality, firstErrPos+1) != chiNext // next position ALSO has wrong chirality
-            && fa_Get(chirality, firstErrPos+2) == chi3rd // but after that it's ok
-        ) {
-            // Swap these character
-            fa_Swap(codes, firstErrPos, firstErrPos + 1);
-            fa_Swap(chirality, firstErrPos, firstErrPos + 1);
-            return tryAgain;
-        }
+        alphabet->meaningCount[c] = (unsigned char)count;
+        alphabet->classes[c]      = alphabet->meanings[c][0];
+    }
 
-        // looks like a delete
-        fa_InsertAt(codes, firstErrPos, 0);
-        fa_InsertAt(chirality, firstErrPos, chi);
+    // Letters not otherwise used take the meaning of their other case
+    for (int i = 0; i < 256; i++) {
+        char other = mc_OtherCase((char)i);
+        if (other == 0 || alphabet->classes[i] != MC_BROKEN || alphabet->meaningCount[i] != 0) continue;
 
-        return tryAgain;
+        unsigned char o = (unsigned char)other;
+        alphabet->classes[i]      = alphabet->classes[o];
+        alphabet->meaningCount[i] = alphabet->meaningCount[o];
+        for (int j = 0; j < alphabet->meaningCount[o]; j++) alphabet->meanings[i][j] = alphabet->meanings[o][j];
     }
 
-    // If input is longer than expected, guess where the problem is and delete
-    if (currentLength > expectedCodeLength) {
-        // First, if the last code is bad chirality, delete that before anything else
-        int expectedLastChi = (1 + expectedCodeLength) & 1;
-        if (fa_Get(chirality, currentLength - 1) != expectedLastChi) {
-            fa_Pop(codes);
-            fa_Pop(chirality);
-            return tryAgain;
-        }
+    return 0;
+}
 
-        // Delete value and chirality at error position
-        if (firstErrPos < 0) firstErrPos = currentLength - 1;
-        fa_DeleteAt(codes, firstErrPos);
-        fa_DeleteAt(chirality, firstErrPos);
+#pragma endregion Alphabets
 
-        return tryAgain;
-    }
+/** Classify a character using the active alphabet's look-up table */
+int mc_ClassifyFast(char src) {
+    mc_EnsureTables();
+    return mc_activeAlphabet->classes[(unsigned char)src];
+}
 
-    // Input is correct length, but we have swapped characters.
-    // Try swapping at first error, unless it is at the end.
-    if (firstErrPos >= expectedCodeLength - 1) {
-        return completed;
+/**
+ * Classify a character. If it is a look-alike that doesn't match the expected
+ * chirality, use the first other meaning that does match.
+ * Returns as for mc_Classify.
+ */
+int mc_ClassifyLookAlike(char src, int chirality) {
+    int symbol = mc_ClassifyFast(src);
+    if (symbol < 0 || (symbol >> 4) == chirality) return symbol;
+
+    unsigned char c = (unsigned char)src;
+    for (int i = 1; i < mc_activeAlphabet->meaningCount[c]; i++) {
+        int alt = mc_activeAlphabet->meanings[c][i];
+        if (alt >= 0 && (alt >> 4) == chirality) return alt;
     }
+    return symbol;
+}
 
-    if (fa_Get(chirality, firstErrPos) == fa_Get(chirality, firstErrPos + 1)) {
-        // A simple swap won't fix this. Either a totally wrong code, or repeated insertions and deletions.
-        // For now, we will flip the chirality without changing anything so the checks can continue.
+/** Message value, and message output position to encoded character */
+char mc_EncodeDisplay(int number, int position) {
+    if (number < 0 || number > 15) return '~';
+    mc_EnsureTables();
+    if ((position & 1) == 0) return mc_activeAlphabet->odd[number];
+    return mc_activeAlphabet->even[number];
+}
 
-        fa_Set(chirality, firstErrPos, 1 - fa_Get(chirality, firstErrPos));
+/** Length of display string for a number of symbols, including separators but not the terminator */
+int mc_DisplayLength(int symbolCount) {
+    if (symbolCount < 1) return 0;
+    return symbolCount + (symbolCount - 1) / 2;
+}
 
-        return tryAgain;
+/**
+ * Write a symbol to a display string, with any separator that comes before it.
+ * @param result display string being written
+ * @param j offset in result to write at
+ * @param number symbol value
+ * @param position symbol position in message
+ * @return offset after written characters
+ */
+int mc_DisplaySymbol(char* result, int j, int number, int position) {
+    if (position > 0) {
+        if (position % 4 == 0) result[j++] = '-';
+        else if (position % 2 == 0) result[j++] = ' ';
     }
 
-    // swapping characters might fix the problem
-    fa_Swap(codes, firstErrPos, firstErrPos + 1);
-    fa_Swap(chirality, firstErrPos, firstErrPos + 1);
+    result[j++] = mc_EncodeDisplay(number, position);
+    return j;
+}
 
-    return tryAgain;
+/** Look up display characters in the active alphabet for a symbol pair at an even position */
+const char* mc_DisplayPair(int pair) {
+    mc_EnsureTables();
+    return mc_activeAlphabet->pairs[pair & 0xff];
 }
 
-/** Try to decode a string input, and correct transpositions */
-FlexArray mc_DecodeDisplay(int expectedCodeLength, const char* input) {
-    if (input == NULL || expectedCodeLength < 1) return NULL;
-    int validCharCount = 0;
-    int safetyLimit    = expectedCodeLength * 4;
-    char upperCase = 'a' - 'A';
+/** Build the shared look-up tables. Only called once, from mc_EnsureTables */
+void mc_BuildTables(void) {
+    mc_BuildBuiltinAlphabet(&mc_builtinAlphabet);
 
-    // Run filters first, to get the number of 'correct' characters.
-    // We could extend this to store the location of unexpected chars to improve the next loop.
-    int inputLength = 0;
-    for (int i = 0; i < safetyLimit; i++) {
-        if (input[i] == 0) {
-            inputLength = i;
-            break;
+    // If any of these fail, encoding with that symbol count uses the general encoder
+    for (int sym = 2; sym <= RS_PACKED_MAX_SYM; sym++) rs_BuildByteTable(sym);
+}
+
+/**
+ * Write symbols that follow some whole pairs of symbols, with separators, and terminate the string.
+ * An odd count leaves one symbol on its own at the end.
+ * @param out display string being written
+ * @param pairsBefore number of symbol pairs already written
+ * @param symbols symbol values
+ * @param count number of symbols
+ * @return position of terminator
+ */
+char* mc_DisplayTail(char* out, long long pairsBefore, const int* symbols, int count) {
+    for (int k = 0; k < count; k += 2) {
+        long long pair = pairsBefore + k / 2;
+        if (pair > 0) *out++ = (pair & 1) ? ' ' : '-';
+
+        if (k + 1 < count) {
+            const char* chars = mc_DisplayPair(((symbols[k] & 0x0f) << 4) | (symbols[k + 1] & 0x0f));
+            out[0] = chars[0];
+            out[1] = chars[1];
+            out += 2;
+        } else {
+            *out++ = mc_activeAlphabet->odd[symbols[k] & 0x0f];
         }
-        char src = input[i];
-        if (mc_IsSpace(src)) continue; // skip spaces
+    }
 
-        if (src >= 'a') src = (char)(src-upperCase);
-        src = mc_CaseChanges(src); // Q->q, S->s, B->b
-        src = mc_Correction(src); // fix for anticipated transcription errors
+    *out = 0;
+    return out;
+}
 
-        int oddIdx  = mc_IndexOf(OddSet, src);
-        int evenIdx = mc_IndexOf(EvenSet, src);
-        if (oddIdx >= 0 || evenIdx >= 0) validCharCount++;
+/**
+ * Encode and display in one pass, for 2 to RS_PACKED_MAX_SYM correction symbols.
+ * Each data byte is one symbol pair, so it is written straight out as two characters
+ * while its parity is added in. No intermediate arrays are used.
+ * @param result buffer for at least mc_DisplayLength(dataLength * 2 + sym) + 1 characters
+ * @return non-zero if the null-terminated code was written to result
+ */
+int mc_EncodeFusedInto(const unsigned char* data, int dataLength, int sym, char* result) {
+    if (data == NULL || result == NULL || dataLength < 1 || sym < 2 || sym > RS_PACKED_MAX_SYM) return 0;
+    mc_EnsureTables();
+    if (!rs_byteTableBuilt[sym]) return 0;
+
+    const uint64_t* table = rs_byteTables[sym];
+    uint64_t mask  = rs_PackedMask(sym);
+    int topShift   = 4 * (sym - 2);
+    uint64_t state = 0;
+    char* out      = result;
+
+    // Data: pairs alternate space and dash separators
+    for (int i = 0; i < dataLength; i++) {
+        if (i > 0) *out++ = (i & 1) ? ' ' : '-';
+
+        const char* pair = mc_DisplayPair(data[i]);
+        out[0] = pair[0];
+        out[1] = pair[1];
+        out += 2;
+
+        int index = (int)(state >> topShift) ^ data[i];
+        state     = ((state << 8) & mask) ^ table[index];
     }
-    if (inputLength < 1) return NULL;
 
-    // negative = too many chars. Positive = too few.
-    int charCountMismatch = expectedCodeLength - validCharCount;
+    // Parity: first symbol is in the top nybble
+    int parity[RS_PACKED_MAX_SYM];
+    for (int k = 0; k < sym; k++) parity[k] = (int)(state >> (4 * (sym - 1 - k))) & 0x0f;
+    mc_DisplayTail(out, dataLength, parity, sym);
+    return -1;
+}
 
-    // set up arrays
-    FlexArray codes     = fa_Create(0, validCharCount+16);
-    FlexArray chirality = fa_Create(0, validCharCount+16);
+/**
+ * Encode and display in one pass, as mc_EncodeFusedInto
+ * @return null-terminated string, or NULL on failure. Free this after use.
+ */
+char* mc_EncodeFused(const unsigned char* data, int dataLength, int sym) {
+    if (dataLength < 1) return NULL;
+    char* result = ALLOCATE(mc_DisplayLength(dataLength * 2 + sym) + 1, 1);
+    if (result == NULL) return NULL;
 
-    if (codes == NULL || chirality == NULL) {
-        fa_Release(&codes);
-        fa_Release(&chirality);
+    if (!mc_EncodeFusedInto(data, dataLength, sym, result)) {
+        FREE(result);
         return NULL;
     }
+    return result;
+}
+
+/** Longest data for the register-resident codec: data fits in one word, and parity in another */
+#define MC_SMALL_MAX_DATA 7
+
+/** Most correction symbols for the register-resident codec. Above this, syndromes repeat */
+#define MC_SMALL_MAX_SYM 15
+
+/**
+ * Parity of a short message held in a word, with the first byte in the top byte of 'dataLength'.
+ * Returns non-zero with 'sym' parity symbols in 'parity', the first in the top nybble, or zero if there is no table.
+ */
+int mc_SmallParity(uint64_t data, int dataLength, int sym, uint64_t* parity) {
+    if (sym == 0) {
+        *parity = 0;
+        return -1;
+    }
+
+    if (sym == 1) {
+        // Generator is x + 1, so parity is the sum of the data symbols
+        data ^= data >> 32;
+        data ^= data >> 16;
+        data ^= data >> 8;
+        data ^= data >> 4;
+        *parity = data & 0x0f;
+        return -1;
+    }
+
+    if (!rs_byteTableBuilt[sym]) return 0;
+    const uint64_t* table = rs_byteTables[sym];
+    uint64_t mask  = rs_PackedMask(sym);
+    int topShift   = 4 * (sym - 2);
+    uint64_t state = 0;
+
+    for (int i = dataLength - 1; i >= 0; i--) {
+        int index = (int)(state >> topShift) ^ (int)((data >> (8 * i)) & 0xff);
+        state     = ((state << 8) & mask) ^ table[index];
+    }
+
+    *parity = state;
+    return -1;
+}
+
+/**
+ * Encode up to MC_SMALL_MAX_DATA bytes with message and parity in registers
+ * @return null-terminated string, or NULL if the shape is not small or on failure. Free this after use.
+ */
+char* mc_EncodeSmall(const unsigned char* data, int dataLength, int sym) {
+    if (dataLength < 1 || dataLength > MC_SMALL_MAX_DATA || sym < 0 || sym > MC_SMALL_MAX_SYM) return NULL;
+    mc_EnsureTables();
+
+    uint64_t message = 0;
+    for (int i = 0; i < dataLength; i++) message = (message << 8) | data[i];
+
+    uint64_t parity;
+    if (!mc_SmallParity(message, dataLength, sym, &parity)) return NULL;
+
+    char* result = ALLOCATE(mc_DisplayLength(dataLength * 2 + sym) + 1, 1);
+    if (result == NULL) return NULL;
+
+    int symbols[2 * MC_SMALL_MAX_DATA + MC_SMALL_MAX_SYM];
+    int count = 0;
+    for (int i = 2 * dataLength - 1; i >= 0; i--) symbols[count++] = (int)(message >> (4 * i)) & 0x0f;
+    for (int k = sym - 1; k >= 0; k--) symbols[count++] = (int)(parity >> (4 * k)) & 0x0f;
+
+    mc_DisplayTail(result, 0, symbols, count);
+    return result;
+}
+
+/**
+ * Decode a short code that has no errors, with message and parity in registers.
+ * Parity is recalculated from the data and compared, which is the same test as all syndromes being zero.
+ * 'codeLength' is the number of characters in input, or -1 if it is null-terminated.
+ * @return MultiCode_Clean with data in output, otherwise MultiCode_NeedsCorrection for the general decoder to check
+ */
+MultiCodeStatus mc_DecodeSmall(const char* input, int codeLength, int dataLength, int sym, unsigned char* output) {
+    if (input == NULL || output == NULL || dataLength < 1 || dataLength > MC_SMALL_MAX_DATA
+        || sym < 0 || sym > MC_SMALL_MAX_SYM) return MultiCode_NeedsCorrection;
+    mc_EnsureTables();
+
+    const signed char* classes = mc_activeAlphabet->classes;
+    int expectedCodeLength = dataLength * 2 + sym;
+    int dataSymbols        = dataLength * 2;
+    int safetyLimit        = expectedCodeLength * 4;
+    uint64_t message       = 0;
+    uint64_t received      = 0;
+    int position           = 0;
+
+    for (int i = 0;; i++) {
+        if (i == codeLength || input[i] == 0) break;
+        if (i >= safetyLimit) return MultiCode_NeedsCorrection;
+
+        int symbol = classes[(unsigned char)input[i]];
+        if (symbol == MC_SPACE) continue;
+        if (symbol < 0 || (symbol >> 4) != (position & 1) || position >= expectedCodeLength) return MultiCode_NeedsCorrection;
+
+        if (position < dataSymbols) message = (message << 4) | (uint64_t)(symbol & 0x0f);
+        else received = (received << 4) | (uint64_t)(symbol & 0x0f);
+        position++;
+    }
+    if (position != expectedCodeLength) return MultiCode_NeedsCorrection;
+
+    uint64_t parity;
+    if (!mc_SmallParity(message, dataLength, sym, &parity) || parity != received) return MultiCode_NeedsCorrection;
+
+    for (int i = 0; i < dataLength; i++) output[i] = (unsigned char)(message >> (8 * (dataLength - 1 - i)));
+    return MultiCode_Clean;
+}
+
+/** Create an output string for message data. Result must be free()'d */
+char* mc_Display(FlexArray message) {
+    int length = mc_DisplayLength(fa_Length(message)) + 1; // space for terminator
+
+    char* result = ALLOCATE(length, 1);
+    if (result == NULL) return NULL;
+
+    int j = 0;
+    for (int i = 0; i < fa_Length(message); i++) {
+        j = mc_DisplaySymbol(result, j, fa_Get(message, i), i);
+    }
+
+    result[j] = 0; // ensure terminator
+    return result;
+}
+
+/** Limits on the work done by one decode */
+typedef struct mc_Budget {
+    int decodeAttempts;   //!< Reed-Solomon decodes left, or -1 for no limit
+    int repairIterations; //!< repair steps left, or -1 for no limit
+    long long deadline;   //!< MultiCode_MonotonicNanos() value to stop at, or zero for none
+    int exhausted;        //!< set non-zero when any limit is reached
+} mc_Budget;
+
+/** Set up a budget from public options. NULL options give no limits */
+void mc_BudgetInit(mc_Budget* budget, const MultiCodeOptions* options) {
+    budget->decodeAttempts   = -1;
+    budget->repairIterations = -1;
+    budget->deadline         = 0;
+    budget->exhausted        = 0;
+    if (options == NULL) return;
+
+    if (options->maxDecodeAttempts > 0) budget->decodeAttempts = options->maxDecodeAttempts;
+    if (options->maxRepairIterations > 0) budget->repairIterations = options->maxRepairIterations;
+    if (options->deadline > 0) budget->deadline = options->deadline;
+}
+
+/**
+ * Take one unit of work from a counter in the budget.
+ * @return non-zero if the work can go ahead. If not, the budget is marked as exhausted.
+ * A NULL budget has no limits.
+ */
+int mc_BudgetSpend(mc_Budget* budget, int* counter) {
+    if (budget == NULL) return -1;
+    if (budget->exhausted) return 0;
+
+    if (*counter == 0 || (budget->deadline > 0 && MultiCode_MonotonicNanos() >= budget->deadline)) {
+        budget->exhausted = -1;
+        return 0;
+    }
+
+    if (*counter > 0) (*counter)--;
+    return -1;
+}
+
+/** Alternating chirality: bit i is (i & 1). As 64 is even, every word of a mask has the same pattern */
+#define MC_CHIRALITY_PATTERN 0xAAAAAAAAAAAAAAAAULL
+
+/** Number of words in a packed chirality mask of 'count' codes */
+#define MC_MASK_WORDS(count) (((count) + 63) >> 6)
+
+/** Chirality signatures from mc_MaskSignature: one bit for each of three codes, set where chirality is wrong */
+#define MC_SIG_FIRST 1 //!< error at the first code
+#define MC_SIG_NEXT 2  //!< error at the code after
+#define MC_SIG_THIRD 4 //!< error at the code after that
+
+/** Index of the lowest set bit. 'value' must not be zero */
+int mc_LowestBit(uint64_t value) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (int)index;
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int index = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/** Chirality of code 'i' in a packed mask */
+int mc_MaskBit(const uint64_t* mask, int i) {
+    return (int)(mask[i >> 6] >> (i & 63)) & 1;
+}
+
+/** Set chirality of code 'i' in a packed mask */
+void mc_MaskSet(uint64_t* mask, int i, int chirality) {
+    uint64_t bit = 1ULL << (i & 63);
+    mask[i >> 6] = chirality ? mask[i >> 6] | bit : mask[i >> 6] & ~bit;
+}
+
+/** Swap chirality of codes 'i' and 'i + 1' */
+void mc_MaskSwap(uint64_t* mask, int i) {
+    if (mc_MaskBit(mask, i) != mc_MaskBit(mask, i + 1)) {
+        mask[i >> 6] ^= 1ULL << (i & 63);
+        mask[(i + 1) >> 6] ^= 1ULL << ((i + 1) & 63);
+    }
+}
+
+/** Set the first 'count' codes of a mask to the alternating pattern, starting with odd */
+void mc_MaskSetAlternating(uint64_t* mask, int count) {
+    int whole = count >> 6;
+    for (int w = 0; w < whole; w++) mask[w] = MC_CHIRALITY_PATTERN;
+    if (count & 63) {
+        uint64_t keep = ~0ULL << (count & 63);
+        mask[whole]   = (mask[whole] & keep) | (MC_CHIRALITY_PATTERN & ~keep);
+    }
+}
+
+/**
+ * Find the first code in [start, end) of a packed mask with the wrong chirality.
+ * 'phase' is 1 if the expected pattern is shifted by one code, so even codes are expected at even indexes.
+ * Each word of 64 codes costs one XOR and a count of trailing zeros.
+ * Returns 'end' if every code is correct.
+ */
+int mc_MaskFirstError(const uint64_t* mask, int start, int end, int phase) {
+    if (start >= end) return end;
+    uint64_t pattern = phase ? ~MC_CHIRALITY_PATTERN : MC_CHIRALITY_PATTERN;
+    int word = start >> 6;
+    int last = (end - 1) >> 6;
+
+    uint64_t errors = (mask[word] ^ pattern) & (~0ULL << (start & 63));
+    while (errors == 0) {
+        if (++word > last) return end;
+        errors = mask[word] ^ pattern;
+    }
+
+    int first = (word << 6) + mc_LowestBit(errors);
+    return first < end ? first : end;
+}
+
+/**
+ * Chirality errors of codes 'i', 'i + 1' and 'i + 2' as MC_SIG_* bits, read from the mask in one go.
+ * With the first code wrong, MC_SIG_FIRST | MC_SIG_NEXT is the "ee" or "oo" of a transposition,
+ * and all three set is the run of shifted codes after an insertion or deletion.
+ * Codes at or past 'end' read as correct.
+ */
+int mc_MaskSignature(const uint64_t* mask, int i, int end, int phase) {
+    if (i >= end) return 0;
+    uint64_t pattern = phase ? ~MC_CHIRALITY_PATTERN : MC_CHIRALITY_PATTERN;
+    int word  = i >> 6;
+    int shift = i & 63;
+
+    uint64_t errors = (mask[word] ^ pattern) >> shift;
+    if (shift > 61 && ((word + 1) << 6) < end) errors |= (mask[word + 1] ^ pattern) << (64 - shift);
+    if (end - i < 3) errors &= (1ULL << (end - i)) - 1;
+    return (int)(errors & 7);
+}
+
+/** Convert a repaired code (symbol, with optional tag from bit 4) to repair format, with chirality in bit 4 */
+int mc_TailCode(int code, int chirality) {
+    return (code & 0x0f) | (chirality << 4) | ((code >> 4) << 5);
+}
+
+/** Chirality of a code in repair format */
+int mc_TailChirality(int entry) {
+    return (entry >> 4) & 1;
+}
+
+/** Convert a code in repair format back to symbol, with optional tag from bit 4 */
+int mc_UntailCode(int entry) {
+    return (entry & 0x0f) | ((entry >> 5) << 4);
+}
+
+/**
+ * Repair codes and chirality errors in a single left-to-right pass.
+ * This is the core of the odd/even code repairs.
+ *
+ * Each step finds the first chirality error and makes one repair there.
+ * Repairs never change codes before the first error, so those are moved
+ * to the output and never scanned again.
+ * Chirality is read from a packed mask, so finding the first error and the
+ * signature of the codes around it takes a few word operations.
+ * @param expectedCodeLength length of code we are trying to recover
+ * @param tail input codes, with chirality in bit 4 and an optional tag above that.
+ *             This is used as scratch space, and must have room for at least 'expectedCodeLength' entries.
+ * @param chirality packed mask with bit i set to the chirality of tail[i]. Updated along with 'tail'.
+ * @param length number of codes in 'tail'
+ * @param output array that receives repaired codes, with any tag moved down to bit 4. Should be empty.
+ * @param budget optional limit on repair steps. If this runs out, the remaining codes are passed through as-is.
+ */
+void mc_RepairCodesAndChirality(int expectedCodeLength, int* tail, uint64_t* chirality, int length, FlexArray output, mc_Budget* budget) {
+    if (tail == NULL || chirality == NULL || output == NULL) return;
+
+    int minLength = (2 * expectedCodeLength) / 3;
+    int start     = 0;      // first code in 'tail' not yet moved to output
+    int end       = length; // end of codes in 'tail'
+    int done      = 0;      // number of codes in output. These all have correct chirality
+
+    for (int tries = 0; tries < expectedCodeLength; tries++) {
+        int currentLength = done + end - start;
+
+        if (currentLength < minLength) {
+            // Code is too short to recover accurately
+            break;
+        }
+
+        // Move correct codes to output, up to the first chirality error.
+        // tail[start] should have the chirality of output position 'done', so the pattern is offset by their difference.
+        int phase = (done + start) & 1;
+        int stop  = mc_MaskFirstError(chirality, start, end, phase);
+        while (start < stop) {
+            fa_Push(output, mc_UntailCode(tail[start++]));
+            done++;
+        }
+        int firstErrPos = start < end ? done : -1;
+
+        if (currentLength == expectedCodeLength && firstErrPos < 0) {
+            // Input codes seem correct
+            break;
+        }
+
+        if (budget != NULL && !mc_BudgetSpend(budget, &budget->repairIterations)) break;
+
+        int signature = mc_MaskSignature(chirality, start, end, phase);
+
+        // If input is shorter than expected, guess where a deletion occurred, and insert a zero-value.
+        if (currentLength < expectedCodeLength) {
+            if (firstErrPos < 0) {
+                // error is at the end
+                int chi    = currentLength & 1;
+                int endChi = expectedCodeLength & 1;
+                int diff   = expectedCodeLength - currentLength;
+                if (diff == 1 && chi == endChi) {
+                    // don't add a wrong chi at the end if we're off-by-one.
+                    // Adding at the start moves every code, so they all go back to be checked again.
+                    for (int i = done - 1; i >= 0; i--) {
+                        tail[i] = mc_TailCode(fa_Pop(output), i & 1);
+                    }
+                    mc_MaskSetAlternating(chirality, done);
+                    start = 0;
+                    end   = done;
+                    done  = 0;
+                }
+                // Zero value with correct chirality
+                fa_Push(output, 0);
+                done++;
+                continue;
+            }
+
+            // error not at end.
+            // First, check if this is a transpose and not the first delete:
+            // next position ALSO has wrong chirality, but after that it's ok.
+            if (firstErrPos < currentLength - 3 // not near end
+                && signature == (MC_SIG_FIRST | MC_SIG_NEXT)
+            ) {
+                // Swap these characters
+                int t           = tail[start];
+                tail[start]     = tail[start + 1];
+                tail[start + 1] = t;
+                mc_MaskSwap(chirality, start);
+                continue;
+            }
+
+            // looks like a delete. Insert a zero value with correct chirality
+            fa_Push(output, 0);
+            done++;
+            continue;
+        }
+
+        // If input is longer than expected, guess where the problem is and delete
+        if (currentLength > expectedCodeLength) {
+            // First, if the last code is bad chirality, delete that before anything else.
+            // If all remaining codes are correct, the error is also the last code.
+            int expectedLastChi = (1 + expectedCodeLength) & 1;
+            int lastChi         = start < end ? mc_MaskBit(chirality, end - 1) : (done - 1) & 1;
+            if (lastChi != expectedLastChi || firstErrPos < 0) {
+                if (start < end) {
+                    end--;
+                } else {
+                    fa_Pop(output);
+                    done--;
+                }
+                continue;
+            }
+
+            // Delete value and chirality at error position
+            start++;
+            continue;
+        }
+
+        // Input is correct length, but we have swapped characters.
+        // Try swapping at first error, unless it is at the end.
+        if (firstErrPos >= expectedCodeLength - 1) {
+            break;
+        }
+
+        if ((signature & MC_SIG_NEXT) == 0) {
+            // The next code is correct, so it has the same chirality as this one.
+            // A simple swap won't fix this. Either a totally wrong code, or repeated insertions and deletions.
+            // For now, we will flip the chirality without changing anything so the checks can continue.
+            tail[start] ^= 0x10;
+            mc_MaskSet(chirality, start, mc_TailChirality(tail[start]));
+            continue;
+        }
+
+        // swapping characters might fix the problem
+        int t           = tail[start];
+        tail[start]     = tail[start + 1];
+        tail[start + 1] = t;
+        mc_MaskSwap(chirality, start);
+    }
+
+    // Anything left over is passed through as-is
+    while (start < end) {
+        fa_Push(output, mc_UntailCode(tail[start++]));
+    }
+}
+
+/** Most characters in a group for mc_ClassifyGroups: one more than the display puts there */
+#define MC_GROUP_MAX 3
+
+/**
+ * Count the characters in the next group of input, after any separators from 'at'.
+ * Returns the count, with 'at' moved to the separator or end after the group.
+ */
+int mc_GroupCount(const char* input, int inputLength, int* at) {
+    int i = *at;
+    while (i < inputLength && mc_ClassifyFast(input[i]) == MC_SPACE) i++;
+    int start = i;
+    while (i < inputLength && mc_ClassifyFast(input[i]) != MC_SPACE) i++;
+    *at = i;
+    return i - start;
+}
+
+/** Characters the display puts in a group */
+int mc_GroupSize(int expectedCodeLength, int group) {
+    return expectedCodeLength - 2 * group < 2 ? 1 : 2;
+}
 
-    int nextChir = 0;
+/**
+ * Check if input's separators can be read as hints by mc_ClassifyGroups.
+ * A run of separators ends a group. Input can only be read this way if it has one group for each the
+ * display has, and exactly one group on its own is one character out. Neighbouring groups one long and
+ * one short are a moved separator. More edits than one are left to repair, as guessing them gives more
+ * wrong decodes than right ones.
+ * @return non-zero if the separators can be used
+ */
+int mc_GroupsFit(int expectedCodeLength, const char* input, int inputLength) {
+    int groupCount = (expectedCodeLength + 1) / 2;
+
+    // Neighbouring misfits must balance out
+    int hints    = 0; // misfit groups on their own
+    int run      = 0; // misfit groups in a row
+    int runError = 0; // their total count error
+    int at       = 0;
+    for (int group = 0; group <= groupCount; group++) {
+        int count = mc_GroupCount(input, inputLength, &at);
+        if (group == groupCount) {
+            if (count > 0) return 0;
+        } else {
+            if (count == 0) return 0;
+            int error = count - mc_GroupSize(expectedCodeLength, group);
+            if (error < -1 || error > 1) return 0;
+            if (error != 0) {
+                run++;
+                runError += error;
+                continue;
+            }
+        }
+        if (run == 1) hints++;
+        if (run > 1 && runError != 0) return 0;
+        run      = 0;
+        runError = 0;
+    }
+    if (hints != 1) return 0;
     for (int i = 0; i < inputLength; i++) {
-        char src = input[i];
-        if (mc_IsSpace(src)) continue; // skip spaces
-
-        if (src >= 'a') src = (char)(src-upperCase);
-        src = mc_CaseChanges(src); // Q->q, S->s, B->b
-        src = mc_Correction(src); // fix for anticipated transcription errors
-
-        int oddIdx  = mc_IndexOf(OddSet, src);
-        int evenIdx = mc_IndexOf(EvenSet, src);
-
-        if (oddIdx < 0 && evenIdx < 0) {
-            // Broken character, maybe insert dummy.
-            if (charCountMismatch > 0) {
-                fa_Push(codes, 0);
-                fa_Push(chirality, nextChir);
-                nextChir = 1 - nextChir;
-                charCountMismatch--;
+        if (mc_ClassifyFast(input[i]) == MC_DOUBLE) return 0;
+    }
+    return -1;
+}
+
+/**
+ * Classify input whose separators are where the display puts them, using the count of characters
+ * in each group as evidence of where a character was deleted or inserted. The input must pass mc_GroupsFit.
+ * The group on its own that is one character out gets a placeholder on the side its character's
+ * chirality shows was lost, or drops a broken character, or else the one that leaves the rest in
+ * chirality order. A moved separator is read as it is.
+ * @param tail receives codes as for mc_RepairCodesAndChirality, and must have room for 'expectedCodeLength'
+ * @param chirality packed mask, all zero, that receives the chirality of each code in 'tail'
+ * @param tagged as for mc_DecodeDisplayTagged. Look-alikes are matched to the chirality of their place.
+ * @return number of codes in 'tail'
+ */
+int mc_ClassifyGroups(int expectedCodeLength, const char* input, int inputLength, int tagged, int* tail, uint64_t* chirality) {
+    int groupCount = (expectedCodeLength + 1) / 2;
+    int length     = 0;
+    int lastError  = 0;
+    int at         = 0;
+    for (int group = 0; group < groupCount; group++) {
+        int count = mc_GroupCount(input, inputLength, &at);
+        int start = at - count;
+
+        int next      = at;
+        int size      = mc_GroupSize(expectedCodeLength, group);
+        int error     = count - size;
+        int nextError = group + 1 < groupCount ? mc_GroupCount(input, inputLength, &next) - mc_GroupSize(expectedCodeLength, group + 1) : 0;
+        int alone     = error != 0 && lastError == 0 && nextError == 0;
+        lastError     = error;
+
+        // Read each character with the chirality of its place
+        int codes[MC_GROUP_MAX];
+        int broken[MC_GROUP_MAX];
+        for (int n = 0; n < count; n++) {
+            int want   = (length + n) & 1;
+            int symbol = tagged ? mc_ClassifyLookAlike(input[start + n], want) : mc_ClassifyFast(input[start + n]);
+            broken[n] = symbol < 0;
+            codes[n]  = (broken[n] ? want << 4 : symbol) | (tagged ? (start + n + 1) << 5 : 0);
+        }
+
+        if (alone && error < 0) {
+            // One short. A character with odd chirality is the first of the pair, so the second was lost.
+            if (!broken[0] && mc_TailChirality(codes[0]) == 0) {
+                codes[1]  = 1 << 4;
+                broken[1] = 0;
             } else {
-                charCountMismatch++;
+                codes[1]  = codes[0] | (1 << 4);
+                broken[1] = broken[0];
+                codes[0]  = 0;
+                broken[0] = 0;
             }
-        } else if (oddIdx >= 0 && evenIdx >= 0) {
-            // Should never happen!
-            fa_Release(&codes);
-            fa_Release(&chirality);
-            return fa_Fixed(0);
-        } else if (oddIdx >= 0) {
-            fa_Push(codes, oddIdx);
-            fa_Push(chirality, 0);
-            nextChir = 1;
-        } else {
-            fa_Push(codes, evenIdx);
-            fa_Push(chirality, 1);
-            nextChir = 0;
+            count = size;
+        } else if (alone && error > 0) {
+            // One long. Drop the last broken character, or else the last one that leaves the rest in chirality order.
+            int drop = -1;
+            for (int d = count - 1; d >= 0 && drop < 0; d--) {
+                if (broken[d]) drop = d;
+            }
+            for (int d = count - 1; d >= 0 && drop < 0; d--) {
+                int fits = -1;
+                for (int k = 0, place = length; k < count; k++) {
+                    if (k != d && mc_TailChirality(codes[k]) != (place++ & 1)) fits = 0;
+                }
+                if (fits) drop = d;
+            }
+            if (drop < 0) drop = count - 1;
+            for (int k = drop; k < count - 1; k++) {
+                codes[k]  = codes[k + 1];
+                broken[k] = broken[k + 1];
+            }
+            count = size;
+        }
+
+        for (int k = 0; k < count; k++) {
+            // Broken characters are placeholders with the chirality of their place
+            if (broken[k]) codes[k] = (codes[k] & ~0x1f) | ((length & 1) << 4);
+            chirality[length >> 6] |= (uint64_t)mc_TailChirality(codes[k]) << (length & 63);
+            tail[length++] = codes[k];
         }
     }
+    return length;
+}
 
-    for (int tries = 0; tries < expectedCodeLength; tries++) {
-        if (mc_RepairCodesAndChirality(expectedCodeLength, codes, chirality)) break;
+/**
+ * Try to decode a string input, and correct transpositions.
+ * @param codeLength number of characters in input, or -1 if it is null-terminated
+ * @param tagged if non-zero, look-alike characters are chosen to match chirality where possible,
+ *               and each code is tagged from bit 4 with (1 + input index) of its character.
+ *               Zero tags are for placeholders added during repair.
+ * @param grouped if non-zero, separators are read as hints, as for mc_ClassifyGroups, and NULL is returned
+ *                if they don't fit the display as mc_GroupsFit checks. If zero, separators are ignored.
+ * @param budget optional limit on repair work, or NULL
+ */
+FlexArray mc_DecodeDisplayTagged(int expectedCodeLength, const char* input, int codeLength, int tagged, int grouped,
+                                 mc_Budget* budget) {
+    if (input == NULL || expectedCodeLength < 1) return NULL;
+    MC_PHASE_START(classifyStart);
+    int validCharCount = 0;
+    int safetyLimit    = expectedCodeLength * 4;
+
+    // Run filters first, to get the number of 'correct' characters.
+    // We could extend this to store the location of unexpected chars to improve the next loop.
+    int inputLength = 0;
+    for (int i = 0; i < safetyLimit; i++) {
+        if (i == codeLength || input[i] == 0) {
+            inputLength = i;
+            break;
+        }
+        int symbol = mc_ClassifyFast(input[i]);
+        if (symbol >= 0 || symbol == MC_DOUBLE) validCharCount++;
+    }
+    if (inputLength < 1) return NULL;
+    if (grouped && !mc_GroupsFit(expectedCodeLength, input, inputLength)) return NULL;
+
+    // negative = too many chars. Positive = too few.
+    int charCountMismatch = expectedCodeLength - validCharCount;
+
+    // set up arrays. Codes have chirality in bit 4 until repaired.
+    // Placeholders for broken characters can take the count past both the expected and valid counts,
+    // but never past one code per input character.
+    // Packed chirality bits go first, with the codes after them in the same block.
+    int capacity = (inputLength > expectedCodeLength ? inputLength : expectedCodeLength) + 2;
+    int maskWords = MC_MASK_WORDS(capacity);
+    uint64_t* chirality = mc_ScratchAllocate((size_t)maskWords + (size_t)(capacity + 1) / 2, sizeof(uint64_t));
+    int* tail = chirality == NULL ? NULL : (int*)(chirality + maskWords);
+    FlexArray codes = fa_Create(0, capacity);
+
+    if (chirality == NULL || codes == NULL) {
+        mc_ScratchFree(chirality);
+        fa_Release(&codes);
+        return NULL;
+    }
+    fa_Clear(codes); // fill from start of storage
+
+    // Separators where the display puts them show which groups lost or gained a character
+    int length = 0;
+    if (grouped) {
+        length = mc_ClassifyGroups(expectedCodeLength, input, inputLength, tagged, tail, chirality);
+    } else {
+        int nextChir = 0;
+        for (int i = 0; i < inputLength; i++) {
+            int symbol = tagged ? mc_ClassifyLookAlike(input[i], nextChir) : mc_ClassifyFast(input[i]);
+            if (symbol == MC_SPACE) continue; // skip spaces
+
+            int tag = tagged ? (i + 1) << 5 : 0;
+            if (symbol == MC_BROKEN) {
+                // Broken character, maybe insert dummy.
+                if (charCountMismatch > 0) {
+                    chirality[length >> 6] |= (uint64_t)nextChir << (length & 63);
+                    tail[length++] = (nextChir << 4) | tag;
+                    nextChir = 1 - nextChir;
+                    charCountMismatch--;
+                } else {
+                    charCountMismatch++;
+                }
+            } else if (symbol == MC_DOUBLE) {
+                // Should never happen!
+                mc_ScratchFree(chirality);
+                fa_Release(&codes);
+                return fa_Fixed(0);
+            } else {
+                chirality[length >> 6] |= (uint64_t)(symbol >> 4) << (length & 63);
+                tail[length++] = symbol | tag;
+                nextChir = 1 - (symbol >> 4);
+            }
+        }
     }
 
-    fa_Release(&chirality);
+    MC_PHASE_END(MultiCode_PhaseClassify, classifyStart);
+
+    MC_PHASE_START(repairStart);
+    mc_RepairCodesAndChirality(expectedCodeLength, tail, chirality, length, codes, budget);
+    MC_PHASE_END(MultiCode_PhaseRepair, repairStart);
+
+    mc_ScratchFree(chirality);
     return codes;
 }
 
-/** Try to decode input */
-FlexArray mc_TryHardDecode(FlexArray msg, int sym, int expectedLength)
+/** Try to decode a string input, and correct transpositions */
+FlexArray mc_DecodeDisplay(int expectedCodeLength, const char* input) {
+    return mc_DecodeDisplayTagged(expectedCodeLength, input, -1, 0, 0, NULL);
+}
+
+/**
+ * Try to decode input
+ * @param budget optional limit on Reed-Solomon decodes, or NULL
+ */
+FlexArray mc_TryHardDecode(FlexArray msg, int sym, int expectedLength, mc_Budget* budget)
 {
+    if (!mc_BudgetSpend(budget, budget == NULL ? NULL : &budget->decodeAttempts)) return NULL;
+    MC_PHASE_START(decodeStart);
     FlexArray basicDecode = rs_Decode(msg, sym, expectedLength);
+    MC_PHASE_END(MultiCode_PhaseFirstDecode, decodeStart);
     if (basicDecode != NULL) return basicDecode;
 
     // Normal decoding didn't work. Try rotations
+    MC_PHASE_START(rotationStart);
 
     int end  = fa_Length(msg);
     int half = end / 2;
@@ -1126,10 +2418,19 @@ FlexArray mc_TryHardDecode(FlexArray msg, int sym, int expectedLength)
             break;
         }
 
+        if (!mc_BudgetSpend(budget, budget == NULL ? NULL : &budget->decodeAttempts))
+        {
+            fa_AddStart(msg, r);
+            break;
+        }
+
         fa_Push(msg, r);
 
         basicDecode = rs_Decode(msg, sym, expectedLength);
-        if (basicDecode != NULL) return basicDecode;
+        if (basicDecode != NULL) {
+            MC_PHASE_END(MultiCode_PhaseRotations, rotationStart);
+            return basicDecode;
+        }
     }
 
     // undo
@@ -1150,96 +2451,1767 @@ FlexArray mc_TryHardDecode(FlexArray msg, int sym, int expectedLength)
             break;
         }
 
+        if (!mc_BudgetSpend(budget, budget == NULL ? NULL : &budget->decodeAttempts))
+        {
+            fa_Push(msg, r);
+            break;
+        }
+
         fa_AddStart(msg, r);
 
         basicDecode = rs_Decode(msg, sym, expectedLength);
-        if (basicDecode != NULL) return basicDecode;
+        if (basicDecode != NULL) {
+            MC_PHASE_END(MultiCode_PhaseRotations, rotationStart);
+            return basicDecode;
+        }
     }
 
+    MC_PHASE_END(MultiCode_PhaseRotations, rotationStart);
     return NULL;
 }
 
-#pragma endregion MultiCoder
-
-/**
- * Encode binary data to a multi-code string
- * @param source pointer to start of data
- * @param sourceLength number of bytes in data
- * @param correctionSymbols count of correction symbols to add
- * @return pointer to null-terminated string. Free this after use.
- */
-char* MultiCode_Encode(void* source, int sourceLength, int correctionSymbols) {
-    if (source == NULL || sourceLength < 1) return NULL;
+/** Most look-alike substitutions tried together by mc_ChaseDecode */
+#define MC_CHASE_MAX_SUBSTITUTIONS 3
 
-    unsigned char* data = source;
-    int dataLength = sourceLength;
+/** Most look-alike substitutions considered by mc_ChaseDecode */
+#define MC_CHASE_MAX_CANDIDATES 24
 
-    // Convert from bytes to nybbles
-    FlexArray src = fa_Fixed(dataLength * 2);
-    int j   = 0;
-    for (int i = 0; i < dataLength; i++)
-    {
-        int upper = (data[i] >> 4) & 0x0F;
-        int lower = data[i] & 0x0F;
+/** One possible substitution for mc_ChaseDecode */
+typedef struct mc_ChaseCandidate {
+    int position; //!< code position to change
+    int value;    //!< value to XOR into that position
+    int rank;     //!< lower is more likely
+    int delta[15]; //!< change to each syndrome if this substitution is made
+} mc_ChaseCandidate;
 
-        fa_Set(src, j++, upper);
-        fa_Set(src, j++, lower);
+/**
+ * Check if syndromes are all zero. If not, see if they can be made zero by
+ * changing the erasure position. Returns non-zero if the code would be valid.
+ * @param erasureWeights syndrome multipliers for the erasure position, or NULL if none
+ * @param erasureValue receives value to XOR into the erasure position
+ */
+int mc_ChaseTest(const int* synd, int syndCount, const int* erasureWeights, int* erasureValue) {
+    int zero = -1;
+    for (int k = 0; k < syndCount; k++) {
+        if (synd[k] != 0) zero = 0;
     }
 
-    FlexArray encoded = rs_Encode(src, correctionSymbols);
-
-    char* output  = mc_Display(encoded);
-
-    fa_Release(&encoded);
-    fa_Release(&src);
+    *erasureValue = 0;
+    if (zero) return -1;
+    if (erasureWeights == NULL) return 0;
 
-    return output;
+    // First weight is always 1, so the first syndrome gives the error value. Others must agree.
+    int value = synd[0];
+    for (int k = 1; k < syndCount; k++) {
+        if (g16_Mul(value, erasureWeights[k]) != synd[k]) return 0;
+    }
+    *erasureValue = value;
+    return -1;
 }
 
 /**
- * Decode a multi-code string to binary data
- * @param code pointer to null-terminated string. This is the end-user input.
- * @param dataLength number of bytes in ORIGINAL data
- * @param correctionSymbols count of correction symbols added to code
- * @return pointer to recovered data, or NULL on failure. Length is 'dataLength'. Free this after use
+ * Try other meanings of look-alike characters, most likely first, until the
+ * Reed-Solomon syndromes are all zero. Each attempt is a syndrome check, with no full decode.
+ * If exactly one broken character was replaced by a placeholder, its value is solved directly.
+ * @param codes tagged codes from mc_DecodeDisplayTagged. Tags are removed, and on success
+ *              the array holds the corrected code.
+ * @param input original input string
+ * @param sym count of correction symbols
+ * @param maxAttempts most combinations to check
+ * @return non-zero if a valid code was found
  */
-void* MultiCode_Decode(char* code, int dataLength, int correctionSymbols) {
-    int expectedCodeLength = (dataLength * 2) + correctionSymbols;
-    FlexArray cleanInput   = mc_DecodeDisplay(expectedCodeLength, code);
+int mc_ChaseDecode(FlexArray codes, const char* input, int sym, int maxAttempts) {
+    if (codes == NULL || input == NULL) return 0;
+
+    int length    = fa_Length(codes);
+    int syndCount = sym < 15 ? sym : 15;
+    if (syndCount < 1) return 0;
+
+    mc_ChaseCandidate candidates[MC_CHASE_MAX_CANDIDATES];
+    int candidateCount = 0;
+    int erasure        = -1;
+    int erasureCount   = 0;
+
+    // Find substitutions, and strip tags
+    for (int p = 0; p < length; p++) {
+        int code   = fa_Get(codes, p);
+        int symbol = code & 0x0f;
+        int tag    = code >> 4;
+        fa_Set(codes, p, symbol);
+        if (tag == 0) continue;
+
+        unsigned char src = (unsigned char)input[tag - 1];
+        if (mc_ClassifyFast((char)src) == MC_BROKEN) {
+            erasure = p;
+            erasureCount++;
+            continue;
+        }
 
-    if (fa_Length(cleanInput) < expectedCodeLength) // Input too short
-    {
-        fa_Release(&cleanInput);
-        return NULL;
+        // Characters that are not look-alikes have no meanings, and are skipped
+        for (int rank = 0; rank < mc_activeAlphabet->meaningCount[src]; rank++) {
+            int alt = mc_activeAlphabet->meanings[src][rank];
+            if (alt < 0 || (alt >> 4) != (p & 1) || (alt & 0x0f) == symbol) continue;
+            if (candidateCount >= MC_CHASE_MAX_CANDIDATES) break;
+
+            mc_ChaseCandidate* c = &candidates[candidateCount++];
+            c->position = p;
+            c->value    = (alt & 0x0f) ^ symbol;
+            c->rank     = rank;
+
+            // Changing position p by v changes syndrome k by v * 2^(k * (length - 1 - p))
+            int power = (length - 1 - p) % 15;
+            for (int k = 0; k < syndCount; k++) {
+                c->delta[k] = g16_exp[(g16_log[c->value] + k * power) % 15];
+            }
+        }
     }
 
-    if (fa_Length(cleanInput) > expectedCodeLength) // Input too long
-    {
-        fa_Release(&cleanInput);
-        return NULL;
+    // Most likely substitutions first. Insertion sort is stable, so earlier positions stay first
+    for (int i = 1; i < candidateCount; i++) {
+        mc_ChaseCandidate c = candidates[i];
+        int j = i - 1;
+        while (j >= 0 && candidates[j].rank > c.rank) {
+            candidates[j + 1] = candidates[j];
+            j--;
+        }
+        candidates[j + 1] = c;
     }
 
-    FlexArray decoded = mc_TryHardDecode(cleanInput, correctionSymbols, fa_Length(cleanInput));
+    int erasureWeights[15];
+    int* weights = NULL;
+    if (erasureCount == 1 && syndCount > 1) {
+        int power = (length - 1 - erasure) % 15;
+        for (int k = 0; k < syndCount; k++) erasureWeights[k] = g16_exp[(k * power) % 15];
+        weights = erasureWeights;
+    }
 
-    // Failed to recover
+    int synd[15] = {0};
+    for (int p = 0; p < length; p++) {
+        int symbol = fa_Get(codes, p);
+        for (int k = 0; k < syndCount; k++) {
+            synd[k] = (synd[k] == 0 ? 0 : g16_exp[g16_log[synd[k]] + k]) ^ symbol;
+        }
+    }
+
+    // Try sets of 0, 1, 2... substitutions, never two at the same position
+    int maxSubstitutions = sym / 2 < MC_CHASE_MAX_SUBSTITUTIONS ? sym / 2 : MC_CHASE_MAX_SUBSTITUTIONS;
+    int chosen[MC_CHASE_MAX_SUBSTITUTIONS];
+    int attempts = 0;
+
+    for (int size = 0; size <= maxSubstitutions && size <= candidateCount; size++) {
+        for (int i = 0; i < size; i++) chosen[i] = i;
+
+        for (;;) {
+            int valid = -1;
+            for (int i = 1; i < size && valid; i++) {
+                for (int j = 0; j < i; j++) {
+                    if (candidates[chosen[i]].position == candidates[chosen[j]].position) valid = 0;
+                }
+            }
+
+            if (valid) {
+                if (attempts >= maxAttempts) return 0;
+                attempts++;
+
+                int test[15];
+                for (int k = 0; k < syndCount; k++) {
+                    test[k] = synd[k];
+                    for (int i = 0; i < size; i++) test[k] ^= candidates[chosen[i]].delta[k];
+                }
+
+                int erasureValue;
+                if (mc_ChaseTest(test, syndCount, weights, &erasureValue)) {
+                    for (int i = 0; i < size; i++) {
+                        mc_ChaseCandidate* c = &candidates[chosen[i]];
+                        fa_Set(codes, c->position, fa_Get(codes, c->position) ^ c->value);
+                    }
+                    if (weights != NULL) fa_Set(codes, erasure, fa_Get(codes, erasure) ^ erasureValue);
+                    return -1;
+                }
+            }
+
+            // Next combination of 'size' candidates
+            int i = size - 1;
+            while (i >= 0 && chosen[i] == candidateCount - size + i) i--;
+            if (i < 0) break;
+            chosen[i]++;
+            for (int j = i + 1; j < size; j++) chosen[j] = chosen[j - 1] + 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Pack decoded symbols into data bytes.
+ * Sixteen symbols are gathered into a word, then written out as eight bytes.
+ * @param decoded decoded symbols, with at least 'dataLength * 2' entries. Correction symbols after those are ignored.
+ * @param output buffer of at least 'dataLength' bytes
+ */
+void mc_PackSymbols(FlexArray decoded, int dataLength, unsigned char* output) {
+    MC_PHASE_START(bytesStart);
+    const int* symbols = decoded->_storage + decoded->_offset;
+
+    int i = 0;
+    for (; i + 8 <= dataLength; i += 8) {
+        uint64_t word = 0;
+        for (int k = 0; k < 16; k++) word = (word << 4) | (uint64_t)(symbols[i * 2 + k] & 0x0f);
+        for (int b = 0; b < 8; b++) output[i + b] = (unsigned char)(word >> (56 - 8 * b));
+    }
+
+    // Remaining bytes
+    for (; i < dataLength; i++) {
+        output[i] = (unsigned char)(((symbols[i * 2] & 0x0f) << 4) | (symbols[i * 2 + 1] & 0x0f));
+    }
+    MC_PHASE_END(MultiCode_PhaseBytes, bytesStart);
+}
+
+/**
+ * Convert decoded symbols to data bytes, ignoring the correction symbols.
+ * @return data bytes, or NULL on failure. Free this after use.
+ */
+char* mc_DataBytes(FlexArray decoded, int sym) {
+    int length = (fa_Length(decoded) - sym) / 2;
+    if (length < 0) return NULL;
+
+    char* final = ALLOCATE(length + 1, 1);
+    if (final == NULL) return NULL;
+
+    mc_PackSymbols(decoded, length, (unsigned char*)final);
+    return final;
+}
+
+/**
+ * Check an input string for errors in a single pass, without allocating.
+ * Checks characters, chirality, length, and Reed-Solomon syndromes.
+ * If output is not NULL, data bytes are written there as they are read.
+ * 'codeLength' is the number of characters in input, or -1 if it is null-terminated.
+ */
+MultiCodeStatus mc_ScanClean(int expectedCodeLength, int sym, const char* input, int codeLength, unsigned char* output) {
+    if (input == NULL || expectedCodeLength < 1 || sym < 0) return MultiCode_Invalid;
+
+    // Syndromes repeat every 15 powers of 2, so we never need to evaluate more than 15
+    int syndromes[15] = {0};
+    int syndCount = sym < 15 ? sym : 15;
+
+    int safetyLimit = expectedCodeLength * 4;
+    int dataSymbols = expectedCodeLength - sym;
+    int position    = 0;
+    int clean       = -1;
+    int terminated  = 0;
+
+    for (int i = 0; i < safetyLimit; i++) {
+        if (i == codeLength || input[i] == 0) {
+            terminated = i > 0;
+            break;
+        }
+
+        int symbol = mc_ClassifyFast(input[i]);
+        if (symbol == MC_SPACE) continue;
+        if (symbol < 0) {
+            // Broken character. Decode would need to repair it
+            clean = 0;
+            position++;
+            continue;
+        }
+
+        if ((symbol >> 4) != (position & 1)) clean = 0; // chirality error
+        symbol &= 0x0f;
+
+        // syndrome[k] = syndrome[k] * 2^k + symbol. Log of 2^k is k, so we can skip the modulo
+        for (int k = 0; k < syndCount; k++) {
+            int s        = syndromes[k];
+            syndromes[k] = (s == 0 ? 0 : g16_exp[g16_log[s] + k]) ^ symbol;
+        }
+
+        if (output != NULL && position < dataSymbols) {
+            if (position & 1) output[position >> 1] |= (unsigned char)symbol;
+            else output[position >> 1] = (unsigned char)(symbol << 4);
+        }
+        position++;
+    }
+
+    if (!terminated) return MultiCode_Invalid;
+
+    // Too short for chirality repair to recover
+    if (position < (2 * expectedCodeLength) / 3) return MultiCode_Invalid;
+
+    if (!clean || position != expectedCodeLength) return MultiCode_NeedsCorrection;
+
+    for (int k = 0; k < syndCount; k++) {
+        if (syndromes[k] != 0) return MultiCode_NeedsCorrection;
+    }
+
+    return MultiCode_Clean;
+}
+
+/**
+ * Read an input string into one lane of a structure-of-arrays block.
+ * 'lanes' has one word per code position, and this code's symbols go in nybble 'lane'.
+ * Returns non-zero if the input has the correct length and chirality, with no broken characters.
+ */
+int mc_ScanLane(int expectedCodeLength, const char* input, uint64_t* lanes, int lane) {
+    if (input == NULL) return 0;
+
+    int safetyLimit = expectedCodeLength * 4;
+    int position    = 0;
+    int shift       = lane * 4;
+
+    for (int i = 0; i < safetyLimit; i++) {
+        if (input[i] == 0) return position == expectedCodeLength;
+
+        int symbol = mc_ClassifyFast(input[i]);
+        if (symbol == MC_SPACE) continue;
+        if (symbol < 0 || position >= expectedCodeLength || (symbol >> 4) != (position & 1)) return 0;
+
+        lanes[position++] |= (uint64_t)(symbol & 0x0f) << shift;
+    }
+    return 0;
+}
+
+MultiCodeStatus mc_DecodeSlice(const char* code, int codeLength, int dataLength, int correctionSymbols,
+                               const MultiCodeOptions* options, void* output);
+
+/**
+ * Decode a block of up to 16 codes that share the same shape.
+ * Syndromes for the whole block are calculated together, and only
+ * codes with errors are passed to the full decoder.
+ * @param factors packed multiply factors for each syndrome evaluation point
+ * @param lanes scratch space of one word per code position
+ * @return number of codes decoded
+ */
+int mc_DecodeBlock(const char* const* codes, int count, int dataLength, int sym,
+                   const uint64_t (*factors)[4], uint64_t* lanes,
+                   unsigned char* output, MultiCodeStatus* statuses) {
+    int expectedCodeLength = (dataLength * 2) + sym;
+    int syndCount          = sym < 15 ? sym : 15;
+
+    for (int p = 0; p < expectedCodeLength; p++) lanes[p] = 0;
+
+    // Normalise each code into its lane
+    int scanned = 0;
+    for (int lane = 0; lane < count; lane++) {
+        if (mc_ScanLane(expectedCodeLength, codes[lane], lanes, lane)) scanned |= 1 << lane;
+    }
+
+    // Syndromes for all lanes. Any non-zero nybble marks an error in that lane
+    uint64_t errors = 0;
+    for (int k = 0; k < syndCount; k++) {
+        uint64_t synd = 0;
+        for (int p = 0; p < expectedCodeLength; p++) {
+            synd = g16_MulPacked(synd, factors[k]) ^ lanes[p];
+        }
+        errors |= synd;
+    }
+    errors |= errors >> 1;
+    errors |= errors >> 2;
+    errors &= G16_LOW_BITS;
+
+    int decoded = 0;
+    for (int lane = 0; lane < count; lane++) {
+        unsigned char* target = output + lane * dataLength;
+        int shift = lane * 4;
+
+        if ((scanned & (1 << lane)) && ((errors >> shift) & 1) == 0) {
+            // Clean: read bytes straight out of the lanes
+            for (int i = 0; i < dataLength; i++) {
+                int upper = (int)(lanes[i * 2] >> shift) & 0x0f;
+                int lower = (int)(lanes[i * 2 + 1] >> shift) & 0x0f;
+                target[i] = (unsigned char)((upper << 4) | lower);
+            }
+            if (statuses != NULL) statuses[lane] = MultiCode_Clean;
+            decoded++;
+            continue;
+        }
+
+        // Needs repair or correction: use the full decoder, straight into the lane's output
+        MultiCodeStatus status = mc_DecodeSlice(codes[lane], -1, dataLength, sym, NULL, target);
+        if (statuses != NULL) statuses[lane] = status;
+        if (status == MultiCode_Clean || status == MultiCode_Corrected) decoded++;
+    }
+
+    return decoded;
+}
+
+#pragma endregion MultiCoder
+
+/**
+ * Encode binary data to a multi-code string
+ * @param source pointer to start of data
+ * @param sourceLength number of bytes in data
+ * @param correctionSymbols count of correction symbols to add
+ * @return pointer to null-terminated string. Free this after use.
+ */
+char* MultiCode_Encode(void* source, int sourceLength, int correctionSymbols) {
+    if (source == NULL || sourceLength < 1) return NULL;
+
+    unsigned char* data = source;
+    int dataLength = sourceLength;
+
+    // Whole code fits in two words
+    if (dataLength <= MC_SMALL_MAX_DATA && correctionSymbols >= 0 && correctionSymbols <= MC_SMALL_MAX_SYM) {
+        char* small = mc_EncodeSmall(data, dataLength, correctionSymbols);
+        if (small != NULL) return small;
+    }
+
+    // Parity fits in a word: encode straight from bytes to display
+    if (correctionSymbols >= 2 && correctionSymbols <= RS_PACKED_MAX_SYM) {
+        char* fused = mc_EncodeFused(data, dataLength, correctionSymbols);
+        if (fused != NULL) return fused;
+    }
+
+    // Convert from bytes to nybbles
+    FlexArray src = fa_Fixed(dataLength * 2);
+    int j   = 0;
+    for (int i = 0; i < dataLength; i++)
+    {
+        int upper = (data[i] >> 4) & 0x0F;
+        int lower = data[i] & 0x0F;
+
+        fa_Set(src, j++, upper);
+        fa_Set(src, j++, lower);
+    }
+
+    FlexArray encoded = rs_Encode(src, correctionSymbols);
+
+    char* output  = mc_Display(encoded);
+
+    fa_Release(&encoded);
+    fa_Release(&src);
+
+    return output;
+}
+
+/**
+ * Read input into codes, repair and decode them. Separators are ignored first, as they often
+ * are in typed input. If that reading doesn't decode, and the separators fit the display, the input
+ * is read again using them as hints to where characters were lost or added.
+ * @param codeLength number of characters in code, or -1 if it is null-terminated
+ * @param maxAttempts look-alike combinations to check, or -1 to read look-alikes as their usual symbol
+ * @param budget optional limit on decode work, or NULL
+ * @param cleanInput receives the codes last read. Release this after use.
+ * @return decoded codes, which may be 'cleanInput' itself, or NULL on failure
+ */
+FlexArray mc_ReadAndDecode(const char* code, int codeLength, int expectedCodeLength, int sym, int maxAttempts,
+                           mc_Budget* budget, FlexArray* cleanInput) {
+    int tagged  = maxAttempts >= 0 ? -1 : 0;
+    *cleanInput = mc_DecodeDisplayTagged(expectedCodeLength, code, codeLength, tagged, 0, budget);
+
+    for (int grouped = 0;; grouped = -1) {
+        if (fa_Length(*cleanInput) == expectedCodeLength) { // Otherwise input is too short or too long
+            if (tagged && mc_ChaseDecode(*cleanInput, code, sym, maxAttempts)) return *cleanInput;
+
+            FlexArray decoded = mc_TryHardDecode(*cleanInput, sym, expectedCodeLength, budget);
+            if (decoded != NULL) return decoded;
+        }
+        if (grouped || (budget != NULL && budget->exhausted)) return NULL;
+
+        // Reading the same codes again would fail the same way
+        FlexArray regrouped = mc_DecodeDisplayTagged(expectedCodeLength, code, codeLength, tagged, -1, budget);
+        if (regrouped == NULL || fa_Equal(regrouped, *cleanInput)) {
+            fa_Release(&regrouped);
+            return NULL;
+        }
+        fa_Release(cleanInput);
+        *cleanInput = regrouped;
+    }
+}
+
+/**
+ * Decode a multi-code string to binary data
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @return pointer to recovered data, or NULL on failure. Length is 'dataLength'. Free this after use
+ */
+void* MultiCode_Decode(char* code, int dataLength, int correctionSymbols) {
+    // Short codes with no errors are read straight into registers
+    if (dataLength >= 1 && dataLength <= MC_SMALL_MAX_DATA) {
+        unsigned char small[MC_SMALL_MAX_DATA];
+        if (mc_DecodeSmall(code, -1, dataLength, correctionSymbols, small) == MultiCode_Clean) {
+            unsigned char* result = ALLOCATE(dataLength, 1);
+            if (result == NULL) return NULL;
+            for (int i = 0; i < dataLength; i++) result[i] = small[i];
+            return result;
+        }
+    }
+
+    int expectedCodeLength = (dataLength * 2) + correctionSymbols;
+    FlexArray cleanInput   = NULL;
+    FlexArray decoded      = mc_ReadAndDecode(code, -1, expectedCodeLength, correctionSymbols, -1, NULL, &cleanInput);
+
+    // Failed to recover
     if (decoded == NULL) {
         fa_Release(&cleanInput);
         return NULL;
     }
 
-    // remove error correction symbols
-    for (int i = 0; i < correctionSymbols; i++) fa_Pop(decoded);
+    char* final = mc_DataBytes(decoded, correctionSymbols);
+    if (decoded != cleanInput) fa_Release(&decoded);
+    fa_Release(&cleanInput);
+    return final;
+}
+
+/**
+ * Decode a multi-code string to binary data, trying other meanings of look-alike characters.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param maxAttempts most look-alike combinations to check before falling back to MultiCode_Decode
+ * @return pointer to recovered data, or NULL on failure. Length is 'dataLength'. Free this after use
+ */
+void* MultiCode_DecodeLookAlike(char* code, int dataLength, int correctionSymbols, int maxAttempts) {
+    int expectedCodeLength = (dataLength * 2) + correctionSymbols;
+    FlexArray cleanInput   = NULL;
+    FlexArray decoded      = mc_ReadAndDecode(code, -1, expectedCodeLength, correctionSymbols,
+                                              maxAttempts < 0 ? 0 : maxAttempts, NULL, &cleanInput);
 
-    // decoded data is nybbles, convert back to bytes
-    int length = fa_Length(decoded) / 2;
-    char* final = ALLOCATE(length + 1, 1);
-    for (int i = 0; i < length; i++)
-    {
-        int upper = (fa_PopFirst(decoded) << 4) & 0xF0;
-        int lower = fa_PopFirst(decoded) & 0x0F;
-        final[i]  = (char)(upper + lower);
+    // Failed to recover
+    if (decoded == NULL) {
+        fa_Release(&cleanInput);
+        return NULL;
     }
+
+    char* final = mc_DataBytes(decoded, correctionSymbols);
     if (decoded != cleanInput) fa_Release(&decoded);
     fa_Release(&cleanInput);
     return final;
 }
+
+/**
+ * Decode input that is a code with no errors, without allocating
+ * @param codeLength number of characters in code, or -1 if it is null-terminated
+ * @return MultiCode_Clean if data was written to output, MultiCode_NeedsCorrection if it could be
+ *         corrected by mc_CorrectSlice, otherwise MultiCode_Invalid
+ */
+MultiCodeStatus mc_CheckSlice(const char* code, int codeLength, int dataLength, int correctionSymbols, void* output) {
+    if (dataLength < 1 || output == NULL) return MultiCode_Invalid;
+
+    // Most codes are correct, and short ones are checked entirely in registers
+    if (dataLength <= MC_SMALL_MAX_DATA && mc_DecodeSmall(code, codeLength, dataLength, correctionSymbols, output) == MultiCode_Clean) {
+        return MultiCode_Clean;
+    }
+
+    // Longer codes are checked without allocating
+    return mc_ScanClean((dataLength * 2) + correctionSymbols, correctionSymbols, code, codeLength, output);
+}
+
+/**
+ * Repair and correct input that mc_CheckSlice found needs correction
+ * @param codeLength number of characters in code, or -1 if it is null-terminated
+ * @return MultiCode_Corrected if data was written to output, MultiCode_BudgetExhausted if a limit was
+ *         reached first, otherwise MultiCode_Invalid
+ */
+MultiCodeStatus mc_CorrectSlice(const char* code, int codeLength, int dataLength, int correctionSymbols,
+                                const MultiCodeOptions* options, void* output) {
+    int expectedCodeLength = (dataLength * 2) + correctionSymbols;
+
+    mc_Budget budget;
+    mc_BudgetInit(&budget, options);
+
+    FlexArray cleanInput = NULL;
+    FlexArray decoded    = mc_ReadAndDecode(code, codeLength, expectedCodeLength, correctionSymbols, -1, &budget, &cleanInput);
+
+    // Failed to recover
+    if (decoded == NULL) {
+        fa_Release(&cleanInput);
+        return budget.exhausted ? MultiCode_BudgetExhausted : MultiCode_Invalid;
+    }
+
+    mc_PackSymbols(decoded, dataLength, output);
+
+    if (decoded != cleanInput) fa_Release(&decoded);
+    fa_Release(&cleanInput);
+    return MultiCode_Corrected;
+}
+
+/**
+ * Decode to binary data, as MultiCode_DecodeEx
+ * @param codeLength number of characters in code, or -1 if it is null-terminated
+ */
+MultiCodeStatus mc_DecodeSlice(const char* code, int codeLength, int dataLength, int correctionSymbols,
+                               const MultiCodeOptions* options, void* output) {
+    MultiCodeStatus status = mc_CheckSlice(code, codeLength, dataLength, correctionSymbols, output);
+    if (status != MultiCode_NeedsCorrection) return status;
+    return mc_CorrectSlice(code, codeLength, dataLength, correctionSymbols, options, output);
+}
+
+/**
+ * Decode a multi-code string to binary data, with limits on the work done.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param options limits on decode work, or NULL for none
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return MultiCode_Clean or MultiCode_Corrected if data was written to output,
+ *         MultiCode_BudgetExhausted if a limit was reached first, otherwise MultiCode_Invalid
+ */
+MultiCodeStatus MultiCode_DecodeEx(const char* code, int dataLength, int correctionSymbols,
+                                   const MultiCodeOptions* options, void* output) {
+    return mc_DecodeSlice(code, -1, dataLength, correctionSymbols, options, output);
+}
+
+/**
+ * Decode a multi-code string to binary data, writing into a caller's buffer.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return MultiCode_Clean or MultiCode_Corrected if data was written to output, otherwise MultiCode_Invalid
+ */
+MultiCodeStatus MultiCode_DecodeInto(const char* code, int dataLength, int correctionSymbols, uint8_t* output) {
+    return MultiCode_DecodeEx(code, dataLength, correctionSymbols, NULL, output);
+}
+
+/**
+ * Decode a multi-code string that is not null-terminated, such as a slice of a larger buffer.
+ * @param code pointer to end-user input. This is not changed, and nothing past 'codeLength' is read.
+ * @param codeLength number of characters in code
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return as for MultiCode_DecodeInto. Inputs too long to decode are Invalid, without being read.
+ */
+MultiCodeStatus MultiCode_DecodeN(const char* code, size_t codeLength, int dataLength, int correctionSymbols,
+                                  uint8_t* output) {
+    if (code == NULL || dataLength < 1 || correctionSymbols < 0) return MultiCode_Invalid;
+
+    // Same limit as for null-terminated input, where the terminator must come before this
+    size_t safetyLimit = ((size_t)dataLength * 2 + (size_t)correctionSymbols) * 4;
+    if (codeLength < 1 || codeLength >= safetyLimit) return MultiCode_Invalid;
+
+    return mc_DecodeSlice(code, (int)codeLength, dataLength, correctionSymbols, NULL, output);
+}
+
+/** Scratch memory for one thread */
+typedef struct MultiCodeContextObj {
+    mc_Pool pool;                          //!< re-used for temporary arrays during decode
+    const MultiCodeAlphabetObj* alphabet;  //!< display characters, or NULL for the built-in set
+} MultiCodeContextObj;
+
+/**
+ * Create a context for encoding and decoding on one thread
+ * @return new context, or NULL on failure. Destroy this after use.
+ */
+MultiCodeContext MultiCode_ContextCreate(void) {
+    mc_EnsureTables();
+    return ALLOCATE(1, sizeof(MultiCodeContextObj));
+}
+
+/** Release a context and all of its scratch memory */
+void MultiCode_ContextDestroy(MultiCodeContext* reference) {
+    if (reference == NULL || *reference == NULL) return;
+    mc_PoolRelease(&(*reference)->pool);
+    FREE(*reference);
+    *reference = NULL;
+}
+
+/**
+ * Decode a multi-code string to binary data, using a context's scratch memory
+ * @param context context owned by the calling thread
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param options limits on decode work, or NULL for none
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return as for MultiCode_DecodeEx
+ */
+MultiCodeStatus MultiCode_ContextDecode(MultiCodeContext context, const char* code, int dataLength,
+                                        int correctionSymbols, const MultiCodeOptions* options, uint8_t* output) {
+    if (context == NULL) return MultiCode_Invalid;
+
+    mc_Pool* previous = mc_activePool;
+    const MultiCodeAlphabetObj* previousAlphabet = mc_activeAlphabet;
+    mc_activePool = &context->pool;
+    if (context->alphabet != NULL) mc_activeAlphabet = context->alphabet;
+
+    MultiCodeStatus status = MultiCode_DecodeEx(code, dataLength, correctionSymbols, options, output);
+
+    mc_activePool     = previous;
+    mc_activeAlphabet = previousAlphabet;
+    return status;
+}
+
+/**
+ * Encode binary data to a multi-code string in a caller's buffer, using a context's scratch memory
+ * @param context context owned by the calling thread
+ * @param data pointer to start of data
+ * @param dataLength number of bytes in data
+ * @param correctionSymbols count of correction symbols to add
+ * @param output buffer to receive null-terminated string
+ * @param outputSize size of output buffer. Must be more than MultiCode_EncodedLength(dataLength, correctionSymbols)
+ * @return length of string written, or -1 on failure
+ */
+int MultiCode_ContextEncode(MultiCodeContext context, const void* data, int dataLength, int correctionSymbols,
+                            char* output, int outputSize) {
+    if (context == NULL || data == NULL || output == NULL || dataLength < 1 || correctionSymbols < 0) return -1;
+
+    int length = MultiCode_EncodedLength(dataLength, correctionSymbols);
+    if (outputSize <= length) return -1;
+
+    mc_Pool* previous = mc_activePool;
+    const MultiCodeAlphabetObj* previousAlphabet = mc_activeAlphabet;
+    mc_activePool = &context->pool;
+    if (context->alphabet != NULL) mc_activeAlphabet = context->alphabet;
+
+    // General encoder for correction symbol counts the fused encoder can't do
+    char* code = NULL;
+    int fused  = mc_EncodeFusedInto(data, dataLength, correctionSymbols, output);
+    if (!fused) code = MultiCode_Encode((void*)data, dataLength, correctionSymbols);
+
+    mc_activePool     = previous;
+    mc_activeAlphabet = previousAlphabet;
+
+    if (fused) return length;
+
+    if (code == NULL) return -1;
+    for (int i = 0; i <= length; i++) output[i] = code[i];
+    FREE(code);
+    return length;
+}
+
+/**
+ * Check an alphabet definition, and build its look-up tables
+ * @param definition display characters and input rules
+ * @return new alphabet, or NULL if the definition is not valid. Destroy this after use.
+ */
+MultiCodeAlphabet MultiCode_AlphabetCreate(const MultiCodeAlphabetDefinition* definition) {
+    if (definition == NULL) return NULL;
+    mc_EnsureTables();
+
+    MultiCodeAlphabet alphabet = ALLOCATE(1, sizeof(MultiCodeAlphabetObj));
+    if (alphabet == NULL) return NULL;
+
+    if (mc_BuildAlphabet(alphabet, definition) < 0) {
+        FREE(alphabet);
+        return NULL;
+    }
+    return alphabet;
+}
+
+/** Release an alphabet. It must not be in use by any context */
+void MultiCode_AlphabetDestroy(MultiCodeAlphabet* reference) {
+    if (reference == NULL || *reference == NULL) return;
+    FREE(*reference);
+    *reference = NULL;
+}
+
+/**
+ * Set the alphabet used by a context's encode and decode calls
+ * @param context context owned by the calling thread
+ * @param alphabet alphabet from MultiCode_AlphabetCreate, or NULL for the built-in one.
+ *                 This must not be destroyed while the context uses it.
+ */
+void MultiCode_ContextSetAlphabet(MultiCodeContext context, MultiCodeAlphabet alphabet) {
+    if (context == NULL) return;
+    context->alphabet = alphabet;
+}
+
+/** State of a streaming encode */
+typedef struct MultiCodeEncoderObj {
+    int sym;          //!< number of correction symbols
+    long long pairs;  //!< data bytes written so far. Each is one symbol pair
+    uint64_t packed;  //!< parity, for 2 to RS_PACKED_MAX_SYM symbols with a remainder table
+    const int* generator; //!< generator polynomial, for other symbol counts. Otherwise NULL
+    int* remainder;   //!< parity, for other symbol counts. Otherwise NULL
+} MultiCodeEncoderObj;
+
+/**
+ * Start a streaming encode. Memory used depends only on the number of correction symbols.
+ * @param correctionSymbols count of correction symbols to add
+ * @return encoder, or NULL on failure. This is released by MultiCode_EncoderFinal.
+ */
+MultiCodeEncoder MultiCode_EncoderInit(int correctionSymbols) {
+    if (correctionSymbols < 0) return NULL;
+    mc_EnsureTables();
+
+    int packed = correctionSymbols >= 2 && correctionSymbols <= RS_PACKED_MAX_SYM && rs_byteTableBuilt[correctionSymbols];
+    int extra  = packed ? 0 : (2 * correctionSymbols + 1);
+
+    MultiCodeEncoder encoder = ALLOCATE(1, sizeof(MultiCodeEncoderObj) + (size_t)extra * sizeof(int));
+    if (encoder == NULL) return NULL;
+    encoder->sym = correctionSymbols;
+    if (packed) return encoder;
+
+    // General case: keep the generator, and run the same LFSR as rs_Encode one symbol at a time
+    FlexArray gen = g16_IrreduciblePoly(correctionSymbols);
+    if (gen == NULL) {
+        FREE(encoder);
+        return NULL;
+    }
+
+    int* generator     = (int*)(encoder + 1);
+    encoder->generator = generator;
+    encoder->remainder = generator + correctionSymbols + 1;
+    for (int j = 0; j <= correctionSymbols; j++) generator[j] = fa_Get(gen, j);
+    fa_Release(&gen);
+    return encoder;
+}
+
+/** Add one symbol to a general streaming encoder's parity */
+void mc_EncoderSymbol(MultiCodeEncoder encoder, int symbol) {
+    int sym = encoder->sym;
+    if (sym < 1) return;
+
+    int* remainder = encoder->remainder;
+    int feedback   = symbol ^ remainder[0];
+    for (int j = 0; j < sym - 1; j++) {
+        remainder[j] = remainder[j + 1] ^ g16_Mul(encoder->generator[j + 1], feedback);
+    }
+    remainder[sym - 1] = g16_Mul(encoder->generator[sym], feedback);
+}
+
+/**
+ * Add data to a streaming encode, and write out its display characters.
+ * @param encoder encoder from MultiCode_EncoderInit
+ * @param data pointer to next part of data
+ * @param dataLength number of bytes in this part
+ * @param output buffer for display characters. Must have room for 3 characters per byte. Not null-terminated.
+ * @return number of characters written, or -1 on failure
+ */
+int MultiCode_EncoderUpdate(MultiCodeEncoder encoder, const void* data, int dataLength, char* output) {
+    if (encoder == NULL || output == NULL || dataLength < 0 || (data == NULL && dataLength > 0)) return -1;
+
+    const unsigned char* bytes = data;
+    char* out = output;
+
+    const uint64_t* table = rs_byteTables[encoder->sym < 2 || encoder->sym > RS_PACKED_MAX_SYM ? 0 : encoder->sym];
+    uint64_t mask  = rs_PackedMask(encoder->sym);
+    int topShift   = 4 * (encoder->sym - 2);
+
+    for (int i = 0; i < dataLength; i++) {
+        if (encoder->pairs > 0) *out++ = (encoder->pairs & 1) ? ' ' : '-';
+        encoder->pairs++;
+
+        const char* pair = mc_DisplayPair(bytes[i]);
+        out[0] = pair[0];
+        out[1] = pair[1];
+        out += 2;
+
+        if (encoder->generator == NULL) {
+            int index       = (int)(encoder->packed >> topShift) ^ bytes[i];
+            encoder->packed = ((encoder->packed << 8) & mask) ^ table[index];
+        } else {
+            mc_EncoderSymbol(encoder, (bytes[i] >> 4) & 0x0f);
+            mc_EncoderSymbol(encoder, bytes[i] & 0x0f);
+        }
+    }
+
+    return (int)(out - output);
+}
+
+/**
+ * Write out the correction symbols of a streaming encode, without releasing it
+ * @return number of characters written, not including the terminator, or -1 on failure or if no data was given
+ */
+int mc_EncoderFinish(MultiCodeEncoder encoder, char* output) {
+    if (output == NULL || encoder->pairs < 1) return -1;
+
+    int sym = encoder->sym;
+    const int* parity = encoder->remainder;
+
+    int packedParity[RS_PACKED_MAX_SYM];
+    if (encoder->generator == NULL) {
+        for (int k = 0; k < sym; k++) packedParity[k] = (int)(encoder->packed >> (4 * (sym - 1 - k))) & 0x0f;
+        parity = packedParity;
+    }
+
+    return (int)(mc_DisplayTail(output, encoder->pairs, parity, sym) - output);
+}
+
+/**
+ * Finish a streaming encode: write out the correction symbols, and release the encoder.
+ * @param reference encoder from MultiCode_EncoderInit. This is set to NULL.
+ * @param output buffer for display characters. Must have room for (2 * correctionSymbols + 1) characters.
+ *               This is null-terminated.
+ * @return number of characters written, not including the terminator, or -1 on failure or if no data was given
+ */
+int MultiCode_EncoderFinal(MultiCodeEncoder* reference, char* output) {
+    if (reference == NULL || *reference == NULL) return -1;
+    MultiCodeEncoder encoder = *reference;
+    *reference = NULL;
+
+    int result = mc_EncoderFinish(encoder, output);
+    FREE(encoder);
+    return result;
+}
+
+/** Reed-Solomon and display parameters for one data length and correction symbol count */
+typedef struct MultiCodePlanObj {
+    int dataLength;        //!< bytes of data
+    int sym;               //!< correction symbols
+    int codeLength;        //!< symbols in code: data and correction
+    int displayLength;     //!< characters in code, with separators but not the terminator
+    int packed;            //!< non-zero if encode uses the shared byte remainder table
+    const int* generator;  //!< generator polynomial, sym + 1 terms, stored after this struct
+} MultiCodePlanObj;
+
+/**
+ * Prepare to encode and decode one shape of code.
+ * Everything that depends only on the lengths is worked out here, in one block of memory.
+ * @param dataLength number of bytes in data
+ * @param correctionSymbols count of correction symbols added to code
+ * @return plan, or NULL on failure. This is never changed, so can be shared between threads. Destroy after use.
+ */
+MultiCodePlan MultiCode_PlanCreate(int dataLength, int correctionSymbols) {
+    if (dataLength < 1 || correctionSymbols < 0) return NULL;
+    mc_EnsureTables();
+
+    FlexArray gen = g16_IrreduciblePoly(correctionSymbols);
+    if (gen == NULL) return NULL;
+
+    MultiCodePlanObj* plan = ALLOCATE(1, sizeof(MultiCodePlanObj) + (size_t)(correctionSymbols + 1) * sizeof(int));
+    if (plan == NULL) {
+        fa_Release(&gen);
+        return NULL;
+    }
+
+    int* generator = (int*)(plan + 1);
+    for (int j = 0; j <= correctionSymbols; j++) generator[j] = fa_Get(gen, j);
+    fa_Release(&gen);
+
+    plan->dataLength    = dataLength;
+    plan->sym           = correctionSymbols;
+    plan->codeLength    = dataLength * 2 + correctionSymbols;
+    plan->displayLength = mc_DisplayLength(plan->codeLength);
+    plan->packed        = correctionSymbols >= 2 && correctionSymbols <= RS_PACKED_MAX_SYM && rs_byteTableBuilt[correctionSymbols];
+    plan->generator     = generator;
+
+    // Corrections for this shape can use a syndrome table, if one fits
+    rs_SyndromeTable(plan->codeLength, correctionSymbols, RS_TABLE_MAX_SYM);
+    return plan;
+}
+
+/** Release a plan. It must not be in use by any thread */
+void MultiCode_PlanDestroy(MultiCodePlan* reference) {
+    if (reference == NULL || *reference == NULL) return;
+    FREE((void*)*reference);
+    *reference = NULL;
+}
+
+/**
+ * Encode data of the plan's length to a multi-code string in a caller's buffer
+ * @param plan plan from MultiCode_PlanCreate
+ * @param data pointer to start of data. Length is the plan's data length.
+ * @param output buffer to receive null-terminated string
+ * @param outputSize size of output buffer. Must be more than MultiCode_EncodedLength for the plan.
+ * @return length of string written, or -1 on failure
+ */
+int MultiCode_PlanEncode(MultiCodePlan plan, const void* data, char* output, int outputSize) {
+    if (plan == NULL || data == NULL || output == NULL || outputSize <= plan->displayLength) return -1;
+
+    if (plan->packed) {
+        return mc_EncodeFusedInto(data, plan->dataLength, plan->sym, output) ? plan->displayLength : -1;
+    }
+
+    // Other symbol counts: run the plan's generator as a streaming encode
+    MultiCodeEncoderObj encoder = {0};
+    encoder.sym       = plan->sym;
+    encoder.generator = plan->generator;
+    encoder.remainder = mc_ScratchAllocate(plan->sym + 1, sizeof(int));
+    if (encoder.remainder == NULL) return -1;
+
+    int length = MultiCode_EncoderUpdate(&encoder, data, plan->dataLength, output);
+    int tail   = mc_EncoderFinish(&encoder, output + length);
+    mc_ScratchFree(encoder.remainder);
+
+    return tail < 0 ? -1 : length + tail;
+}
+
+/**
+ * Decode a multi-code string of the plan's shape
+ * @param plan plan from MultiCode_PlanCreate
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param options limits on decode work, or NULL for none
+ * @param output buffer of at least the plan's data length to receive the data
+ * @return as for MultiCode_DecodeEx
+ */
+MultiCodeStatus MultiCode_PlanDecode(MultiCodePlan plan, const char* code, const MultiCodeOptions* options,
+                                     uint8_t* output) {
+    if (plan == NULL) return MultiCode_Invalid;
+    return mc_DecodeSlice(code, -1, plan->dataLength, plan->sym, options, output);
+}
+
+/** Rank penalty for a format that would need more placeholders than it has correction symbols */
+#define MC_ANY_UNLIKELY 1000
+
+/** Rank past the best fit that MultiCode_DecodeAny still corrects: up to two characters further from it */
+#define MC_ANY_SLACK 4
+
+/** Shapes of code to try when decoding */
+typedef struct MultiCodeFormatSetObj {
+    int count;
+    int maxCodeLength;                //!< longest code length of any format
+    const MultiCodeFormat* formats;   //!< 'count' formats, stored after this struct
+} MultiCodeFormatSetObj;
+
+/**
+ * Register the shapes of code that input may have
+ * @param formats array of shapes. This is copied.
+ * @param count number of shapes
+ * @return format set, or NULL on failure. This is never changed, so can be shared between threads. Destroy after use.
+ */
+MultiCodeFormatSet MultiCode_FormatSetCreate(const MultiCodeFormat* formats, int count) {
+    if (formats == NULL || count < 1) return NULL;
+
+    MultiCodeFormatSetObj* set = ALLOCATE(1, sizeof(MultiCodeFormatSetObj) + (size_t)count * sizeof(MultiCodeFormat));
+    if (set == NULL) return NULL;
+
+    MultiCodeFormat* copy = (MultiCodeFormat*)(set + 1);
+    set->count         = count;
+    set->maxCodeLength = 0;
+    set->formats       = copy;
+
+    for (int i = 0; i < count; i++) {
+        if (formats[i].dataLength < 1 || formats[i].correctionSymbols < 0) {
+            FREE(set);
+            return NULL;
+        }
+        copy[i] = formats[i];
+        int codeLength = formats[i].dataLength * 2 + formats[i].correctionSymbols;
+        if (codeLength > set->maxCodeLength) set->maxCodeLength = codeLength;
+    }
+    return set;
+}
+
+/** Release a format set. It must not be in use by any thread */
+void MultiCode_FormatSetDestroy(MultiCodeFormatSet* reference) {
+    if (reference == NULL || *reference == NULL) return;
+    FREE((void*)*reference);
+    *reference = NULL;
+}
+
+/**
+ * Decode a multi-code string of any shape in a format set.
+ * The input is classified once to rank the formats. Each is then decoded from the original input,
+ * with its separators, exactly as MultiCode_DecodeEx would.
+ * @param formats format set from MultiCode_FormatSetCreate
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param options limits on decode work for each format tried, or NULL for none. A deadline covers all of them.
+ * @param output buffer of at least the largest data length in the set, to receive the data
+ * @param formatIndex optional, set to the index of the format decoded, or -1 if none was
+ * @return as for MultiCode_DecodeEx
+ */
+MultiCodeStatus MultiCode_DecodeAny(MultiCodeFormatSet formats, const char* code, const MultiCodeOptions* options,
+                                    uint8_t* output, int* formatIndex) {
+    if (formatIndex != NULL) *formatIndex = -1;
+    if (formats == NULL || code == NULL || output == NULL) return MultiCode_Invalid;
+
+    // Every format stops reading at four times its code length, so nothing past the longest of those is needed
+    int safetyLimit = formats->maxCodeLength * 4;
+    int rawLength   = 0;
+    while (rawLength < safetyLimit && code[rawLength] != 0) rawLength++;
+    if (rawLength < 1 || rawLength >= safetyLimit) return MultiCode_Invalid;
+
+    int* order = mc_ScratchAllocate(2 * (size_t)formats->count, sizeof(int));
+    if (order == NULL) return MultiCode_Invalid;
+    int* score = order + formats->count;
+
+    // Classify once, to count valid and broken characters
+    int valid   = 0;
+    int broken  = 0;
+    int lastChi = -1;
+    for (int i = 0; i < rawLength; i++) {
+        int symbol = mc_ClassifyFast(code[i]);
+        if (symbol >= 0) {
+            lastChi = symbol >> 4;
+            valid++;
+        } else if (symbol == MC_DOUBLE) {
+            valid++;
+        } else if (symbol == MC_BROKEN) {
+            broken++;
+        }
+    }
+
+    // Rank formats: closest to the valid character count first, then those whose last code
+    // has the right chirality. Equal ranks keep the order they were registered in.
+    // Formats that would need more placeholders than could be corrected rarely decode, so they rank
+    // after all the others. Formats that MultiCode_DecodeEx would turn down without repair are left out.
+    int candidates = 0;
+    for (int i = 0; i < formats->count; i++) {
+        int sym                = formats->formats[i].correctionSymbols;
+        int expectedCodeLength = formats->formats[i].dataLength * 2 + sym;
+        int missing            = expectedCodeLength - valid;
+        if (rawLength >= expectedCodeLength * 4) continue;                 // read as unterminated
+        if (valid + broken < (2 * expectedCodeLength) / 3) continue;       // too short for repair
+
+        int fit = 2 * (missing < 0 ? -missing : missing);
+        if (lastChi >= 0 && lastChi != ((expectedCodeLength - 1) & 1)) fit++;
+        if (missing > sym) fit += MC_ANY_UNLIKELY;
+
+        int at = candidates++;
+        while (at > 0 && score[at - 1] > fit) {
+            score[at] = score[at - 1];
+            order[at] = order[at - 1];
+            at--;
+        }
+        score[at] = fit;
+        order[at] = i;
+    }
+
+    // A clean code has exactly the valid characters and chirality of its format, so only a perfect fit
+    // can be one. Checking for one doesn't allocate.
+    MultiCodeStatus result = MultiCode_Invalid;
+    for (int c = 0; c < candidates && score[c] == 0 && broken == 0; c++) {
+        const MultiCodeFormat* format = &formats->formats[order[c]];
+        if (mc_CheckSlice(code, rawLength, format->dataLength, format->correctionSymbols, output) == MultiCode_Clean) {
+            if (formatIndex != NULL) *formatIndex = order[c];
+            mc_ScratchFree(order);
+            return MultiCode_Clean;
+        }
+    }
+
+    // Correction is most of the cost, and formats further from the input rarely give the right data,
+    // so only those close to the best fit are corrected
+    for (int c = 0; c < candidates && score[c] <= score[0] + MC_ANY_SLACK; c++) {
+        const MultiCodeFormat* format = &formats->formats[order[c]];
+        MultiCodeStatus status = mc_CorrectSlice(code, rawLength, format->dataLength, format->correctionSymbols, options, output);
+
+        if (status == MultiCode_Corrected) {
+            if (formatIndex != NULL) *formatIndex = order[c];
+            result = status;
+            break;
+        }
+        if (status == MultiCode_BudgetExhausted) result = status;
+    }
+
+    mc_ScratchFree(order);
+    return result;
+}
+
+/** Most separators in a row inside a code found by a scanner */
+#define MC_SCAN_MAX_GAP 3
+
+/** Longest run of alternating symbols. Longer runs are split */
+#define MC_SCAN_CHAIN_CAP 0x40000000
+
+/** State of a scan through one stream of text */
+typedef struct MultiCodeScannerObj {
+    MultiCodeFormatSet formats;
+    const MultiCodeAlphabetObj* alphabet; //!< NULL for the built-in alphabet
+    MultiCodeOptions correction;          //!< limits on correcting codes with errors
+    int correct;                          //!< non-zero if codes with errors are corrected
+    int minCodeLength;                    //!< shortest code length of any format
+    int ringLength;                       //!< longest code length of any format
+
+    long long position; //!< stream position of the next character
+    long long last;     //!< stream position of the last symbol in the run
+    int chain;          //!< symbols in the current alternating run, which starts at an odd symbol
+    int head;           //!< ring index for the next symbol
+    int gap;            //!< separators since the last symbol
+    int boundary;       //!< non-zero if the last character was not a symbol
+    int covered;        //!< symbols at the start of the run that are part of a code already found
+
+    int pending;              //!< non-zero if 'match' is held until no longer code could cover it
+    int pendingStart;         //!< run index of the first symbol of the held code
+    MultiCodeScanMatch match; //!< code held back
+
+    MultiCodeScanCallback callback; //!< for the current call
+    void* context;                  //!< for the current call
+    int found;                      //!< codes reported in the current call
+    int stop;                       //!< non-zero if the callback asked to stop
+
+    long long* offsets;     //!< stream position of each of the last 'ringLength' symbols in the run
+    int* order;             //!< format indexes, longest code first
+    char* raw;              //!< input characters of those symbols, written twice so any code is contiguous
+    unsigned char* bounded; //!< non-zero where a symbol follows a separator, broken character, or stream start
+    uint8_t* output;        //!< data decoded by the latest check
+    uint8_t* data;          //!< data of the held code
+} MultiCodeScannerObj;
+
+/**
+ * Start a scan
+ * @param formats shapes of code to find. This must not be destroyed while the scanner uses it.
+ * @param alphabet alphabet of codes to find, or NULL for the built-in one. This must outlive the scanner.
+ * @param correction limits on correcting each code with errors, or NULL to find only codes with no errors
+ * @return scanner, or NULL on failure. Destroy after use.
+ */
+MultiCodeScanner MultiCode_ScannerCreate(MultiCodeFormatSet formats, MultiCodeAlphabet alphabet,
+                                         const MultiCodeOptions* correction) {
+    if (formats == NULL) return NULL;
+    mc_EnsureTables();
+
+    int ringLength    = formats->maxCodeLength;
+    int minCodeLength = ringLength;
+    int maxDataLength = 0;
+    for (int i = 0; i < formats->count; i++) {
+        int codeLength = formats->formats[i].dataLength * 2 + formats->formats[i].correctionSymbols;
+        if (codeLength < minCodeLength) minCodeLength = codeLength;
+        if (formats->formats[i].dataLength > maxDataLength) maxDataLength = formats->formats[i].dataLength;
+    }
+
+    // Offsets first, for alignment, then format order, characters, flags and data
+    size_t size = sizeof(MultiCodeScannerObj) + (size_t)ringLength * (sizeof(long long) + 3)
+                  + (size_t)formats->count * sizeof(int) + 2 * (size_t)maxDataLength;
+    MultiCodeScannerObj* scanner = ALLOCATE(1, size);
+    if (scanner == NULL) return NULL;
+
+    scanner->formats       = formats;
+    scanner->alphabet      = alphabet;
+    scanner->correct       = correction != NULL;
+    scanner->minCodeLength = minCodeLength;
+    scanner->ringLength    = ringLength;
+    scanner->offsets       = (long long*)(scanner + 1);
+    scanner->order         = (int*)(scanner->offsets + ringLength);
+    scanner->raw           = (char*)(scanner->order + formats->count);
+    scanner->bounded       = (unsigned char*)(scanner->raw + 2 * ringLength);
+    scanner->output        = scanner->bounded + ringLength;
+    scanner->data          = scanner->output + maxDataLength;
+    if (correction != NULL) scanner->correction = *correction;
+
+    // Where a shorter code ends a longer one, the longer one is the code, so it is checked first.
+    // Formats of equal length keep their order in the set.
+    for (int i = 0; i < formats->count; i++) {
+        int codeLength = formats->formats[i].dataLength * 2 + formats->formats[i].correctionSymbols;
+        int at         = i;
+        while (at > 0) {
+            const MultiCodeFormat* previous = &formats->formats[scanner->order[at - 1]];
+            if (previous->dataLength * 2 + previous->correctionSymbols >= codeLength) break;
+            scanner->order[at] = scanner->order[at - 1];
+            at--;
+        }
+        scanner->order[at] = i;
+    }
+
+    scanner->boundary = 1;
+    return scanner;
+}
+
+/** Report the held code, if there is one */
+void mc_ScanFlush(MultiCodeScannerObj* scanner) {
+    if (!scanner->pending) return;
+    scanner->pending = 0;
+    scanner->found++;
+    if (scanner->callback(&scanner->match, scanner->context) != 0) scanner->stop = 1;
+}
+
+/**
+ * Hold a code found in the run, whose data is in 'output'. A code of a shorter format can be part
+ * of a longer one, so the code is reported once the run is too long for any format to cover it.
+ * @param start ring index of the code's first symbol
+ * @param runStart run index of the code's first symbol
+ */
+void mc_ScanFound(MultiCodeScannerObj* scanner, int start, int runStart, int formatIndex, MultiCodeStatus status) {
+    // A code covering the held one replaces it. One after it means the held one is complete.
+    if (scanner->pending && runStart > scanner->pendingStart) mc_ScanFlush(scanner);
+
+    const MultiCodeFormat* format = &scanner->formats->formats[formatIndex];
+    for (int i = 0; i < format->dataLength; i++) scanner->data[i] = scanner->output[i];
+
+    scanner->match.offset      = scanner->offsets[start];
+    scanner->match.length      = (int)(scanner->last + 1 - scanner->match.offset);
+    scanner->match.formatIndex = formatIndex;
+    scanner->match.status      = status;
+    scanner->match.data        = scanner->data;
+    scanner->match.dataLength  = format->dataLength;
+    scanner->pending           = 1;
+    scanner->pendingStart      = runStart;
+    scanner->covered           = scanner->chain;
+
+    if (format->dataLength * 2 + format->correctionSymbols == scanner->ringLength) mc_ScanFlush(scanner);
+}
+
+/**
+ * Check a run of symbols with alternating chirality for errors, writing its data to 'output'.
+ * Parity is recalculated from the data and compared, as for mc_DecodeSmall.
+ * @return MultiCode_Clean, or MultiCode_NeedsCorrection
+ */
+MultiCodeStatus mc_ScanCheck(const char* code, int dataLength, int sym, unsigned char* output) {
+    int codeLength = dataLength * 2 + sym;
+    if (sym > RS_PACKED_MAX_SYM) return mc_ScanClean(codeLength, sym, code, codeLength, output);
+
+    const signed char* classes = mc_activeAlphabet->classes;
+    for (int i = 0; i < dataLength; i++) {
+        int upper = classes[(unsigned char)code[2 * i]] & 0x0f;
+        int lower = classes[(unsigned char)code[2 * i + 1]] & 0x0f;
+        output[i] = (unsigned char)((upper << 4) | lower);
+    }
+
+    uint64_t received = 0;
+    for (int i = dataLength * 2; i < codeLength; i++) received = (received << 4) | (uint64_t)(classes[(unsigned char)code[i]] & 0x0f);
+
+    uint64_t parity = 0;
+    if (sym == 1) {
+        // Generator is x + 1, so parity is the sum of the data symbols
+        for (int i = 0; i < dataLength; i++) parity ^= output[i];
+        parity = (parity ^ (parity >> 4)) & 0x0f;
+    } else if (sym > 1 && !rs_EncodeBytes(output, dataLength, sym, &parity)) {
+        return mc_ScanClean(codeLength, sym, code, codeLength, output);
+    }
+    return parity == received ? MultiCode_Clean : MultiCode_NeedsCorrection;
+}
+
+/**
+ * Check codes that end at the last symbol, which is followed by a separator, broken character, or the end of text.
+ * A format is checked where its code would start at an odd symbol that also follows a separator or broken
+ * character, and would not overlap a code already found. Longer formats are checked first, since the end of
+ * a longer code can also be a valid shorter one. When 'ended' is set, the run ends here, and
+ * if it is exactly one code long that is corrected where allowed.
+ */
+void mc_ScanEvaluate(MultiCodeScannerObj* scanner, int ended) {
+    MultiCodeFormatSet formats = scanner->formats;
+
+    for (int i = 0; i < formats->count; i++) {
+        int f          = scanner->order[i];
+        int dataLength = formats->formats[f].dataLength;
+        int sym        = formats->formats[f].correctionSymbols;
+        int codeLength = dataLength * 2 + sym;
+        int runStart   = scanner->chain - codeLength;
+        if (runStart < 0 || (runStart & 1)) continue;
+        if (runStart < scanner->covered && !(scanner->pending && runStart <= scanner->pendingStart)) continue;
+
+        int start = scanner->head - codeLength;
+        if (start < 0) start += scanner->ringLength;
+        if (!scanner->bounded[start]) continue;
+
+        const char* code = scanner->raw + start;
+        MultiCodeStatus status = mc_ScanCheck(code, dataLength, sym, scanner->output);
+
+        if (status != MultiCode_Clean && ended && scanner->correct && runStart == 0) {
+            status = mc_DecodeSlice(code, codeLength, dataLength, sym, &scanner->correction, scanner->output);
+        }
+
+        if (status == MultiCode_Clean || status == MultiCode_Corrected) {
+            mc_ScanFound(scanner, start, runStart, f, status);
+            return;
+        }
+    }
+}
+
+/** End the run at the last symbol. 'bounded' is set if a separator or broken character follows it */
+void mc_ScanEnd(MultiCodeScannerObj* scanner, int bounded) {
+    if (bounded) mc_ScanEvaluate(scanner, 1);
+    mc_ScanFlush(scanner);
+    scanner->chain   = 0;
+    scanner->covered = 0;
+}
+
+/**
+ * Find where the next code could start, between runs. A code starting at or after 'start' would
+ * cover everything up to 'end', so the nearest character before 'end' that no code can contain
+ * rules out every start up to it: a broken character, too many separators, or a symbol with the
+ * same chirality as the one after it. That is found by reading back from 'end', usually within a
+ * few characters, so most text is never read.
+ * @return position to carry on from, with 'boundary' set for the character before it,
+ *         or 'start' if every character up to 'end' could be part of a code
+ */
+size_t mc_ScanSkip(const signed char* classes, const char* text, size_t start, size_t end, int* boundary) {
+    int nextChirality = -1;
+    size_t separators = 0;
+    for (size_t k = end + 1; k-- > start;) {
+        int symbol = classes[(unsigned char)text[k]];
+        if (symbol == MC_SPACE) {
+            if (++separators > MC_SCAN_MAX_GAP) {
+                *boundary = 1;
+                return k + separators;
+            }
+            continue;
+        }
+        if (symbol < 0) {
+            *boundary = 1;
+            return k + 1;
+        }
+        if ((symbol >> 4) == nextChirality) {
+            *boundary = 0;
+            return k + 1;
+        }
+        nextChirality = symbol >> 4;
+        separators    = 0;
+    }
+    return start;
+}
+
+/**
+ * Scan the next part of a stream.
+ * Each character is classified with the alphabet's look-up table. Between runs, text that can't
+ * hold a code is skipped a shortest code length at a time, as for mc_ScanSkip.
+ * @return number of codes found, or -1 if the arguments are not valid
+ */
+int MultiCode_ScannerFeed(MultiCodeScanner scanner, const char* text, size_t length,
+                          MultiCodeScanCallback callback, void* context) {
+    if (scanner == NULL || callback == NULL || (text == NULL && length > 0)) return -1;
+    mc_EnsureTables();
+
+    const MultiCodeAlphabetObj* previousAlphabet = mc_activeAlphabet;
+    if (scanner->alphabet != NULL) mc_activeAlphabet = scanner->alphabet;
+    const signed char* classes = mc_activeAlphabet->classes;
+
+    scanner->callback = callback;
+    scanner->context  = context;
+    scanner->found    = 0;
+    scanner->stop     = 0;
+
+    long long base = scanner->position;
+    size_t ahead   = (size_t)scanner->minCodeLength - 1;
+    size_t i       = 0;
+
+    while (i < length && !scanner->stop) {
+        if (scanner->chain == 0 && length - i > ahead) {
+            size_t next = mc_ScanSkip(classes, text, i, i + ahead, &scanner->boundary);
+            if (next != i) {
+                i            = next;
+                scanner->gap = 0;
+                continue;
+            }
+        }
+
+        int symbol = classes[(unsigned char)text[i]];
+        if (symbol >= 0) {
+            if ((symbol >> 4) != (scanner->chain & 1)) {
+                // Run ends. An odd symbol starts the next one, so it is read again
+                if (scanner->chain > 0) {
+                    mc_ScanEnd(scanner, scanner->gap > 0);
+                    continue;
+                }
+                scanner->boundary = 0;
+                scanner->gap      = 0;
+                i++;
+                continue;
+            }
+            if (scanner->chain == MC_SCAN_CHAIN_CAP) mc_ScanEnd(scanner, 0);
+
+            int at                = scanner->head;
+            scanner->raw[at]      = text[i];
+            scanner->raw[at + scanner->ringLength] = text[i];
+            scanner->offsets[at]  = base + (long long)i;
+            scanner->bounded[at]  = (unsigned char)scanner->boundary;
+            scanner->head         = at + 1 == scanner->ringLength ? 0 : at + 1;
+            scanner->last         = base + (long long)i;
+            scanner->boundary     = 0;
+            scanner->gap          = 0;
+            scanner->chain++;
+
+            if (scanner->pending && scanner->chain - scanner->pendingStart > scanner->ringLength) mc_ScanFlush(scanner);
+        } else if (symbol == MC_SPACE) {
+            if (scanner->chain > 0) {
+                if (scanner->gap == 0) mc_ScanEvaluate(scanner, 0);
+                else if (scanner->gap == MC_SCAN_MAX_GAP) mc_ScanEnd(scanner, 1);
+            }
+            scanner->gap++;
+            scanner->boundary = 1;
+        } else {
+            if (scanner->chain > 0) mc_ScanEnd(scanner, 1);
+            scanner->gap      = 0;
+            scanner->boundary = 1;
+        }
+        i++;
+    }
+
+    // Stopping leaves the rest of this part unread, so no run continues into the next
+    if (scanner->stop) {
+        mc_ScanEnd(scanner, 0);
+        scanner->boundary = 0;
+    }
+    scanner->position = base + (long long)length;
+    mc_activeAlphabet = previousAlphabet;
+    return scanner->found;
+}
+
+/**
+ * End the stream, finding any code at its very end. The scanner can then start a new stream.
+ * @return number of codes found, or -1 if the arguments are not valid
+ */
+int MultiCode_ScannerFinish(MultiCodeScanner scanner, MultiCodeScanCallback callback, void* context) {
+    if (scanner == NULL || callback == NULL) return -1;
+
+    const MultiCodeAlphabetObj* previousAlphabet = mc_activeAlphabet;
+    if (scanner->alphabet != NULL) mc_activeAlphabet = scanner->alphabet;
+
+    scanner->callback = callback;
+    scanner->context  = context;
+    scanner->found    = 0;
+    scanner->stop     = 0;
+    if (scanner->chain > 0) mc_ScanEnd(scanner, 1);
+
+    scanner->position = 0;
+    scanner->head     = 0;
+    scanner->gap      = 0;
+    scanner->boundary = 1;
+    mc_activeAlphabet = previousAlphabet;
+    return scanner->found;
+}
+
+/** Release a scanner */
+void MultiCode_ScannerDestroy(MultiCodeScanner* reference) {
+    if (reference == NULL || *reference == NULL) return;
+    FREE(*reference);
+    *reference = NULL;
+}
+
+/**
+ * Set the memory that syndrome tables may use in total, in bytes. Zero turns them off, and is the default.
+ * @return previous limit
+ */
+size_t MultiCode_SyndromeTableLimit(size_t bytes) {
+    long limit = bytes > (size_t)0x7fffffffL ? 0x7fffffffL : (long)bytes;
+    long previous;
+    do {
+        previous = MC_LOAD_ACQUIRE(&rs_syndromeTableLimit);
+    } while (!MC_COMPARE_SWAP(&rs_syndromeTableLimit, previous, limit));
+    return (size_t)previous;
+}
+
+/**
+ * Build the syndrome table for a shape of code now, rather than on its first correction
+ * @return non-zero if the table is ready
+ */
+int MultiCode_SyndromeTableBuild(int dataLength, int correctionSymbols) {
+    if (dataLength < 1 || correctionSymbols < 0) return 0;
+    mc_EnsureTables();
+    return rs_SyndromeTable(dataLength * 2 + correctionSymbols, correctionSymbols, RS_TABLE_MAX_SYM) != NULL;
+}
+
+/**
+ * Length of the string made by encoding, not including the terminator
+ * @param dataLength number of bytes in data
+ * @param correctionSymbols count of correction symbols to add
+ */
+int MultiCode_EncodedLength(int dataLength, int correctionSymbols) {
+    if (dataLength < 1 || correctionSymbols < 0) return 0;
+    return mc_DisplayLength(dataLength * 2 + correctionSymbols);
+}
+
+/**
+ * Read a monotonic clock, for setting decode deadlines
+ * @return nanoseconds from an arbitrary starting point
+ */
+long long MultiCode_MonotonicNanos(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (long long)((double)count.QuadPart * 1.0e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/**
+ * Check a multi-code string without decoding or correcting it.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @return MultiCode_Clean, MultiCode_NeedsCorrection, or MultiCode_Invalid
+ */
+MultiCodeStatus MultiCode_Check(const char* code, int dataLength, int correctionSymbols) {
+    if (dataLength < 1) return MultiCode_Invalid;
+    int expectedCodeLength = (dataLength * 2) + correctionSymbols;
+    return mc_ScanClean(expectedCodeLength, correctionSymbols, code, -1, NULL);
+}
+
+/**
+ * Decode a multi-code string that has no errors. No corrections are attempted.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return MultiCode_Clean if data was written to output, otherwise as for MultiCode_Check
+ */
+MultiCodeStatus MultiCode_DecodeClean(const char* code, int dataLength, int correctionSymbols, void* output) {
+    if (dataLength < 1 || output == NULL) return MultiCode_Invalid;
+    int expectedCodeLength = (dataLength * 2) + correctionSymbols;
+    return mc_ScanClean(expectedCodeLength, correctionSymbols, code, -1, output);
+}
+
+/**
+ * Decode many multi-code strings that all have the same data length and correction symbols.
+ * @param codes array of pointers to null-terminated strings. These are the end-user inputs.
+ * @param count number of codes
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to codes
+ * @param output buffer of 'count * dataLength' bytes. Data for code 'i' starts at 'i * dataLength'
+ * @param statuses optional array of 'count' results
+ * @return number of codes decoded, or -1 if the batch could not be started
+ */
+int MultiCode_DecodeBatch(const char* const* codes, int count, int dataLength, int correctionSymbols,
+                          void* output, MultiCodeStatus* statuses) {
+    if (codes == NULL || output == NULL || count < 0 || dataLength < 1 || correctionSymbols < 0) return -1;
+
+    int expectedCodeLength = (dataLength * 2) + correctionSymbols;
+    uint64_t* lanes = ALLOCATE(expectedCodeLength, sizeof(uint64_t));
+    if (lanes == NULL) return -1;
+
+    uint64_t factors[15][4];
+    for (int k = 0; k < 15; k++) g16_PackedFactors(g16_Pow(2, k), factors[k]);
+
+    unsigned char* target = output;
+    int decoded = 0;
+    for (int start = 0; start < count; start += G16_LANES) {
+        int blockSize = count - start < G16_LANES ? count - start : G16_LANES;
+        decoded += mc_DecodeBlock(codes + start, blockSize, dataLength, correctionSymbols, (const uint64_t (*)[4])factors,
+                                  lanes, target + start * dataLength, statuses == NULL ? NULL : statuses + start);
+    }
+
+    FREE(lanes);
+    return decoded;
+}
+
+/**
+ * Encode many payloads of the same length to multi-code strings
+ * @param sources array of pointers to data, each 'sourceLength' bytes
+ * @param count number of payloads
+ * @param sourceLength number of bytes in each payload
+ * @param correctionSymbols count of correction symbols to add
+ * @param outputs array of 'count' pointers, set to null-terminated strings. Free each after use.
+ * @return number of payloads encoded, or -1 if the batch could not be started
+ */
+int MultiCode_EncodeBatch(const void* const* sources, int count, int sourceLength, int correctionSymbols, char** outputs) {
+    if (sources == NULL || outputs == NULL || count < 0 || sourceLength < 1 || correctionSymbols < 0) return -1;
+
+    int msgLength   = sourceLength * 2;
+    int codeLength  = msgLength + correctionSymbols;
+    int paritySize  = correctionSymbols > 0 ? correctionSymbols : 1;
+
+    FlexArray gen      = g16_IrreduciblePoly(correctionSymbols);
+    uint64_t* msg      = ALLOCATE(msgLength * 4, sizeof(uint64_t));
+    uint64_t* parity   = ALLOCATE(paritySize * 4, sizeof(uint64_t));
+    uint64_t (*genMasks)[4][4] = ALLOCATE(paritySize, sizeof(uint64_t[4][4]));
+
+    if (gen == NULL || msg == NULL || parity == NULL || genMasks == NULL) {
+        fa_Release(&gen);
+        FREE(msg);
+        FREE(parity);
+        FREE(genMasks);
+        return -1;
+    }
+
+    for (int j = 0; j < correctionSymbols; j++) g16_SlicedFactors(fa_Get(gen, j + 1), genMasks[j]);
+
+    int encoded = 0;
+    for (int start = 0; start < count; start += 64) {
+        int blockSize = count - start < 64 ? count - start : 64;
+
+        // Transpose payload nybbles into bit planes
+        for (int i = 0; i < msgLength * 4; i++) msg[i] = 0;
+        for (int lane = 0; lane < blockSize; lane++) {
+            const unsigned char* data = sources[start + lane];
+            if (data == NULL) continue;
+            for (int i = 0; i < msgLength; i++) {
+                int symbol = (i & 1) ? data[i >> 1] & 0x0F : (data[i >> 1] >> 4) & 0x0F;
+                for (int b = 0; b < 4; b++) msg[i * 4 + b] |= (uint64_t)((symbol >> b) & 1) << lane;
+            }
+        }
+
+        rs_EncodeSliced(msg, msgLength, (const uint64_t (*)[4][4])genMasks, correctionSymbols, parity);
+
+        // Write out each code
+        for (int lane = 0; lane < blockSize; lane++) {
+            const unsigned char* data = sources[start + lane];
+            outputs[start + lane] = NULL;
+            if (data == NULL) continue;
+
+            char* result = ALLOCATE(mc_DisplayLength(codeLength) + 1, 1);
+            if (result == NULL) continue;
+
+            int j = 0;
+            for (int i = 0; i < msgLength; i++) {
+                int symbol = (i & 1) ? data[i >> 1] & 0x0F : (data[i >> 1] >> 4) & 0x0F;
+                j = mc_DisplaySymbol(result, j, symbol, i);
+            }
+            for (int k = 0; k < correctionSymbols; k++) {
+                int symbol = 0;
+                for (int b = 0; b < 4; b++) symbol |= (int)((parity[k * 4 + b] >> lane) & 1) << b;
+                j = mc_DisplaySymbol(result, j, symbol, msgLength + k);
+            }
+            result[j] = 0;
+
+            outputs[start + lane] = result;
+            encoded++;
+        }
+    }
+
+    fa_Release(&gen);
+    FREE(msg);
+    FREE(parity);
+    FREE(genMasks);
+    return encoded;
+}
+
+#ifdef MULTICODE_HISTOGRAMS
+
+/** Names of decode phases, for text and JSON output */
+static const char* mc_phaseNames[MultiCode_PhaseCount] = {
+    "classify", "repair", "firstDecode", "rotations", "bytes"
+};
+
+/**
+ * Add the decode phase histograms of every thread into 'target'.
+ * Counts from threads that are still decoding may be slightly behind.
+ */
+void MultiCode_HistogramMerge(MultiCodeHistogram* target) {
+    if (target == NULL) return;
+    for (mc_ThreadHistogram* item = MC_LOAD_ACQUIRE(&mc_allHistograms); item != NULL; item = item->next) {
+        for (int phase = 0; phase < MultiCode_PhaseCount; phase++) {
+            for (int b = 0; b < MULTICODE_HISTOGRAM_BUCKETS; b++) {
+                target->counts[phase][b] += MC_LOAD_RELAXED(&item->histogram.counts[phase][b]);
+            }
+        }
+    }
+}
+
+/** Smallest duration in nanoseconds that is counted in a histogram bucket */
+unsigned long long MultiCode_HistogramBucketStart(int bucket) {
+    if (bucket < 4) return bucket < 0 ? 0 : (unsigned long long)bucket;
+    int exponent = bucket / 4 + 1;
+    int sub      = bucket % 4;
+    return (unsigned long long)(4 + sub) << (exponent - 2);
+}
+
+/** Append to a buffer, snprintf-style. Keeps counting when the buffer is full */
+void mc_Append(char* buffer, int size, int* used, const char* format, ...) {
+    int space = *used < size ? size - *used : 0;
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(space > 0 ? buffer + *used : NULL, (size_t)space, format, args);
+    va_end(args);
+
+    if (length > 0) *used += length;
+}
+
+/** Write histograms as text or JSON. Returns length needed, not including the terminator */
+int mc_HistogramFormat(const MultiCodeHistogram* histogram, char* buffer, int size, int json) {
+    if (histogram == NULL || size < 0 || (buffer == NULL && size > 0)) return -1;
+    int used = 0;
+
+    if (json) mc_Append(buffer, size, &used, "{");
+    for (int phase = 0; phase < MultiCode_PhaseCount; phase++) {
+        const char* heading = json ? (phase == 0 ? "\"%s\":[" : ",\"%s\":[") : "%s:\n";
+        mc_Append(buffer, size, &used, heading, mc_phaseNames[phase]);
+
+        int first = -1;
+        for (int b = 0; b < MULTICODE_HISTOGRAM_BUCKETS; b++) {
+            unsigned long long count = histogram->counts[phase][b];
+            if (count == 0) continue;
+
+            const char* format = json ? (first ? "[%llu,%llu]" : ",[%llu,%llu]") : "  >=%lluns %llu\n";
+            mc_Append(buffer, size, &used, format, MultiCode_HistogramBucketStart(b), count);
+            first = 0;
+        }
+
+        if (json) mc_Append(buffer, size, &used, "]");
+    }
+    if (json) mc_Append(buffer, size, &used, "}");
+
+    return used;
+}
+
+/**
+ * Write histograms as text: one line per non-empty bucket, with bucket start in nanoseconds and count.
+ * @return length of full text, not including the terminator. If this is 'size' or more, the output was cut short.
+ */
+int MultiCode_HistogramText(const MultiCodeHistogram* histogram, char* buffer, int size) {
+    return mc_HistogramFormat(histogram, buffer, size, 0);
+}
+
+/**
+ * Write histograms as JSON: an object of phase names, each an array of [bucket start ns, count] pairs.
+ * @return length of full text, not including the terminator. If this is 'size' or more, the output was cut short.
+ */
+int MultiCode_HistogramJson(const MultiCodeHistogram* histogram, char* buffer, int size) {
+    return mc_HistogramFormat(histogram, buffer, size, -1);
+}
+
+#endif
@@ -2,6 +2,9 @@
 #ifndef C99_MULTICODE_H
 #define C99_MULTICODE_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifndef ALLOCATE
 #define ALLOCATE calloc
 #endif
@@ -9,6 +12,22 @@
 #define FREE free
 #endif
 
+/** Result of checking or decoding a code */
+typedef enum MultiCodeStatus {
+    MultiCode_Clean           = 0,  //!< Code is correct, with no errors to repair
+    MultiCode_NeedsCorrection = 1,  //!< Code has errors. It may be recoverable with MultiCode_Decode
+    MultiCode_Corrected       = 2,  //!< Code had errors, which were corrected during decode
+    MultiCode_Invalid         = -1, //!< Code can't be decoded
+    MultiCode_BudgetExhausted = -2, //!< A work limit or deadline was reached before the code could be decoded
+} MultiCodeStatus;
+
+/** Limits on the work done by MultiCode_DecodeEx. Zero values mean no limit. */
+typedef struct MultiCodeOptions {
+    int maxDecodeAttempts;   //!< most Reed-Solomon decodes to run, including rotations of the code
+    int maxRepairIterations; //!< most chirality repair steps (insert, delete, or swap)
+    long long deadline;      //!< MultiCode_MonotonicNanos() value after which decoding stops
+} MultiCodeOptions;
+
 /**
  * Encode binary data to a multi-code string
  * @param data pointer to start of data
@@ -19,7 +38,11 @@
 char* MultiCode_Encode(void* data, int dataLength, int correctionSymbols);
 
 /**
- * Decode a multi-code string to binary data
+ * Decode a multi-code string to binary data.
+ * Separators are ignored at first. If that doesn't decode, and the input has a separator at each place
+ * the display puts one, the input is read again with a group one character short or long taken to be
+ * where a character was lost or added. So any code that decodes with separators ignored gives the same
+ * data, and only codes that would otherwise fail can be recovered, or read wrongly, from the separators.
  * @param code pointer to null-terminated string. This is the end-user input.
  * @param dataLength number of bytes in ORIGINAL data
  * @param correctionSymbols count of correction symbols added to code
@@ -27,4 +50,468 @@ char* MultiCode_Encode(void* data, int dataLength, int correctionSymbols);
  */
 void* MultiCode_Decode(char* code, int dataLength, int correctionSymbols);
 
+/**
+ * Decode a multi-code string to binary data, trying other meanings of look-alike characters.
+ * Where characters like 'O', 'I', 'L' and 'U' could mean more than one symbol, combinations of
+ * alternatives are checked most-likely first, each with a quick syndrome test. If no combination
+ * gives a valid code within 'maxAttempts', this falls back to the same correction as MultiCode_Decode.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param maxAttempts most look-alike combinations to check
+ * @return pointer to recovered data, or NULL on failure. Length is 'dataLength'. Free this after use.
+ */
+void* MultiCode_DecodeLookAlike(char* code, int dataLength, int correctionSymbols, int maxAttempts);
+
+/**
+ * Decode a multi-code string to binary data, with limits on the work done.
+ * Clean codes are always decoded. Repair and correction stop when any limit in 'options' is reached.
+ * This gives the same results as MultiCode_Decode when no limits are reached.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param options limits on decode work, or NULL for none
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return MultiCode_Clean or MultiCode_Corrected if data was written to output,
+ *         MultiCode_BudgetExhausted if a limit was reached first, otherwise MultiCode_Invalid
+ */
+MultiCodeStatus MultiCode_DecodeEx(const char* code, int dataLength, int correctionSymbols,
+                                   const MultiCodeOptions* options, void* output);
+
+/**
+ * Decode a multi-code string to binary data, writing into a caller's buffer.
+ * Gives the same results as MultiCode_Decode, but nothing needs to be freed
+ * and clean codes are decoded without allocating.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return MultiCode_Clean or MultiCode_Corrected if data was written to output, otherwise MultiCode_Invalid
+ */
+MultiCodeStatus MultiCode_DecodeInto(const char* code, int dataLength, int correctionSymbols, uint8_t* output);
+
+/**
+ * Decode a multi-code string that is not null-terminated, such as a slice of a larger buffer.
+ * @param code pointer to end-user input. This is not changed, and nothing past 'codeLength' is read.
+ * @param codeLength number of characters in code
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return as for MultiCode_DecodeInto. Inputs too long to decode are Invalid, without being read.
+ */
+MultiCodeStatus MultiCode_DecodeN(const char* code, size_t codeLength, int dataLength, int correctionSymbols,
+                                  uint8_t* output);
+
+// Contexts
+//
+// A context owns scratch memory that is re-used between calls, so decoding on many threads
+// doesn't contend on the heap. Use one context per thread: a context must not be used by two
+// threads at the same time. Look-up tables are built once, then shared read-only by every thread.
+// Functions that don't take a context are also safe to call from many threads.
+
+/** Scratch memory for one thread */
+typedef struct MultiCodeContextObj* MultiCodeContext;
+
+/**
+ * Create a context for encoding and decoding on one thread
+ * @return new context, or NULL on failure. Destroy this after use.
+ */
+MultiCodeContext MultiCode_ContextCreate(void);
+
+/** Release a context and all of its scratch memory */
+void MultiCode_ContextDestroy(MultiCodeContext* reference);
+
+/**
+ * Decode a multi-code string to binary data, using a context's scratch memory
+ * @param context context owned by the calling thread
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param options limits on decode work, or NULL for none
+ * @param output buffer of at least 'dataLength' bytes to receive the data
+ * @return as for MultiCode_DecodeEx
+ */
+MultiCodeStatus MultiCode_ContextDecode(MultiCodeContext context, const char* code, int dataLength,
+                                        int correctionSymbols, const MultiCodeOptions* options, uint8_t* output);
+
+/**
+ * Encode binary data to a multi-code string in a caller's buffer, using a context's scratch memory
+ * @param context context owned by the calling thread
+ * @param data pointer to start of data
+ * @param dataLength number of bytes in data
+ * @param correctionSymbols count of correction symbols to add
+ * @param output buffer to receive null-terminated string
+ * @param outputSize size of output buffer. Must be more than MultiCode_EncodedLength(dataLength, correctionSymbols)
+ * @return length of string written, or -1 on failure
+ */
+int MultiCode_ContextEncode(MultiCodeContext context, const void* data, int dataLength, int correctionSymbols,
+                            char* output, int outputSize);
+
+// Custom alphabets
+//
+// An alphabet has 16 display characters for symbols at odd positions, and another 16 for even positions.
+// No character may be in both sets. Letters not used elsewhere in the alphabet are read as their other case.
+
+/** Display characters and input rules for a custom alphabet */
+typedef struct MultiCodeAlphabetDefinition {
+    const char* oddSet;              //!< 16 printable characters for symbols at odd positions
+    const char* evenSet;             //!< 16 printable characters for symbols at even positions
+    const char* separators;          //!< characters ignored in input, or NULL for " -._+*#"
+    const char* const* lookAlikes;   //!< NULL-terminated list, or NULL for none. Each entry is an input character
+                                     //!< followed by 1 to 4 symbol characters it may mean, most likely first.
+} MultiCodeAlphabetDefinition;
+
+/** Look-up tables for an alphabet */
+typedef struct MultiCodeAlphabetObj* MultiCodeAlphabet;
+
+/**
+ * Check an alphabet definition, and build its look-up tables
+ * @param definition display characters and input rules
+ * @return new alphabet, or NULL if the definition is not valid. Destroy this after use.
+ */
+MultiCodeAlphabet MultiCode_AlphabetCreate(const MultiCodeAlphabetDefinition* definition);
+
+/** Release an alphabet. It must not be in use by any context */
+void MultiCode_AlphabetDestroy(MultiCodeAlphabet* reference);
+
+/**
+ * Set the alphabet used by a context's encode and decode calls
+ * @param context context owned by the calling thread
+ * @param alphabet alphabet from MultiCode_AlphabetCreate, or NULL for the built-in one.
+ *                 This must not be destroyed while the context uses it.
+ */
+void MultiCode_ContextSetAlphabet(MultiCodeContext context, MultiCodeAlphabet alphabet);
+
+// Streaming encoder
+//
+// Data can be given in parts of any size, and display characters are written out as each byte is added.
+// Memory used depends only on the number of correction symbols, not the length of the data.
+// The joined output is the same as MultiCode_Encode on all of the data.
+
+/** State of a streaming encode */
+typedef struct MultiCodeEncoderObj* MultiCodeEncoder;
+
+/**
+ * Start a streaming encode
+ * @param correctionSymbols count of correction symbols to add
+ * @return encoder, or NULL on failure. This is released by MultiCode_EncoderFinal.
+ */
+MultiCodeEncoder MultiCode_EncoderInit(int correctionSymbols);
+
+/**
+ * Add data to a streaming encode, and write out its display characters.
+ * @param encoder encoder from MultiCode_EncoderInit
+ * @param data pointer to next part of data
+ * @param dataLength number of bytes in this part
+ * @param output buffer for display characters. Must have room for 3 characters per byte. Not null-terminated.
+ * @return number of characters written, or -1 on failure
+ */
+int MultiCode_EncoderUpdate(MultiCodeEncoder encoder, const void* data, int dataLength, char* output);
+
+/**
+ * Finish a streaming encode: write out the correction symbols, and release the encoder.
+ * @param reference encoder from MultiCode_EncoderInit. This is set to NULL.
+ * @param output buffer for display characters. Must have room for (2 * correctionSymbols + 1) characters.
+ *               This is null-terminated.
+ * @return number of characters written, not including the terminator, or -1 on failure or if no data was given
+ */
+int MultiCode_EncoderFinal(MultiCodeEncoder* reference, char* output);
+
+// Plans
+//
+// A plan holds everything that depends only on the data length and correction symbol count.
+// Create plans at start-up for each shape of code used, then share them between threads.
+
+/** Pre-computed parameters for one shape of code */
+typedef const struct MultiCodePlanObj* MultiCodePlan;
+
+/**
+ * Prepare to encode and decode one shape of code
+ * @param dataLength number of bytes in data
+ * @param correctionSymbols count of correction symbols added to code
+ * @return plan, or NULL on failure. This is never changed, so can be shared between threads. Destroy after use.
+ */
+MultiCodePlan MultiCode_PlanCreate(int dataLength, int correctionSymbols);
+
+/** Release a plan. It must not be in use by any thread */
+void MultiCode_PlanDestroy(MultiCodePlan* reference);
+
+/**
+ * Encode data of the plan's length to a multi-code string in a caller's buffer
+ * @param plan plan from MultiCode_PlanCreate
+ * @param data pointer to start of data. Length is the plan's data length.
+ * @param output buffer to receive null-terminated string
+ * @param outputSize size of output buffer. Must be more than MultiCode_EncodedLength for the plan.
+ * @return length of string written, or -1 on failure
+ */
+int MultiCode_PlanEncode(MultiCodePlan plan, const void* data, char* output, int outputSize);
+
+/**
+ * Decode a multi-code string of the plan's shape
+ * @param plan plan from MultiCode_PlanCreate
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param options limits on decode work, or NULL for none
+ * @param output buffer of at least the plan's data length to receive the data
+ * @return as for MultiCode_DecodeEx
+ */
+MultiCodeStatus MultiCode_PlanDecode(MultiCodePlan plan, const char* code, const MultiCodeOptions* options,
+                                     uint8_t* output);
+
+// Format sets
+//
+// Where codes of several shapes are in use, a format set decodes input without knowing its shape.
+// The characters of the input are counted once, to rank the shapes by how well they fit. Checking for
+// a code with no errors is cheap, so every shape that fits exactly is checked. Correction is not, so only
+// the shapes that fit best are corrected, and a damaged code costs about as much as one MultiCode_DecodeEx.
+
+/** One shape of code */
+typedef struct MultiCodeFormat {
+    int dataLength;        //!< number of bytes in ORIGINAL data
+    int correctionSymbols; //!< count of correction symbols added to code
+} MultiCodeFormat;
+
+/** Shapes of code to try when decoding */
+typedef const struct MultiCodeFormatSetObj* MultiCodeFormatSet;
+
+/**
+ * Register the shapes of code that input may have
+ * @param formats array of shapes. This is copied.
+ * @param count number of shapes
+ * @return format set, or NULL on failure. This is never changed, so can be shared between threads. Destroy after use.
+ */
+MultiCodeFormatSet MultiCode_FormatSetCreate(const MultiCodeFormat* formats, int count);
+
+/** Release a format set. It must not be in use by any thread */
+void MultiCode_FormatSetDestroy(MultiCodeFormatSet* reference);
+
+/**
+ * Decode a multi-code string of any shape in a format set.
+ * Formats are ranked by how well the count and chirality of the input characters fit them.
+ * A format the input is a code of with no errors is returned first. Otherwise formats up to two
+ * characters further from the input than the best fit are corrected in rank order, and the first
+ * to decode is returned. Formats that would need more placeholders than they have correction symbols
+ * rank after all the others, so are only corrected when none fit better.
+ * This gives the same result as MultiCode_DecodeEx with the returned format, but can fail where
+ * MultiCode_DecodeEx with a poorly fitting format would succeed.
+ * @param formats format set from MultiCode_FormatSetCreate
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param options limits on decode work for each format tried, or NULL for none. A deadline covers all of them.
+ * @param output buffer of at least the largest data length in the set, to receive the data
+ * @param formatIndex optional, set to the index of the format decoded, or -1 if none was
+ * @return MultiCode_Clean or MultiCode_Corrected if data was written to output,
+ *         MultiCode_BudgetExhausted if a limit was reached in any format tried, otherwise MultiCode_Invalid
+ */
+MultiCodeStatus MultiCode_DecodeAny(MultiCodeFormatSet formats, const char* code, const MultiCodeOptions* options,
+                                    uint8_t* output, int* formatIndex);
+
+// Scanning
+//
+// A scanner finds codes in free text, such as log files, given in parts of any size.
+// A code is found where a run of characters alternates between the odd and even sets, with
+// separators anywhere between them, is the length of a format and stands apart from the text
+// around it. Runs are checked with no errors first. Codes with errors are corrected only when the
+// whole run is one code, and when the scanner has correction options. Codes with chirality errors,
+// or more than 3 separators in a row, are not found. With few correction symbols, some ordinary
+// words will read as codes. Where the end of a longer code is also a valid shorter one, the longer
+// code is found.
+
+/** State of a scan through one stream of text */
+typedef struct MultiCodeScannerObj* MultiCodeScanner;
+
+/** A code found by a scanner */
+typedef struct MultiCodeScanMatch {
+    long long offset;       //!< position in the stream of the code's first character
+    int length;             //!< characters from the first to the last character of the code
+    int formatIndex;        //!< index in the scanner's format set
+    MultiCodeStatus status; //!< MultiCode_Clean, or MultiCode_Corrected
+    const uint8_t* data;    //!< decoded data. This is only valid until the callback returns
+    int dataLength;         //!< number of bytes in data
+} MultiCodeScanMatch;
+
+/**
+ * Receive a code found by a scanner
+ * @param match position and decoded data of the code
+ * @param context value given to the scanner
+ * @return zero to continue, or non-zero to stop scanning this part of the text
+ */
+typedef int (*MultiCodeScanCallback)(const MultiCodeScanMatch* match, void* context);
+
+/**
+ * Start a scan
+ * @param formats shapes of code to find. This must not be destroyed while the scanner uses it.
+ * @param alphabet alphabet of codes to find, or NULL for the built-in one. This must outlive the scanner.
+ * @param correction limits on correcting each code with errors, or NULL to find only codes with no errors
+ * @return scanner, or NULL on failure. A scanner must not be used by two threads at the same time. Destroy after use.
+ */
+MultiCodeScanner MultiCode_ScannerCreate(MultiCodeFormatSet formats, MultiCodeAlphabet alphabet,
+                                         const MultiCodeOptions* correction);
+
+/**
+ * Scan the next part of a stream. Codes split between parts are found.
+ * @param scanner scanner from MultiCode_ScannerCreate
+ * @param text characters, which need not be null-terminated
+ * @param length number of characters in text
+ * @param callback called for each code found, in order
+ * @param context passed to the callback
+ * @return number of codes found, or -1 if the arguments are not valid
+ */
+int MultiCode_ScannerFeed(MultiCodeScanner scanner, const char* text, size_t length,
+                          MultiCodeScanCallback callback, void* context);
+
+/**
+ * End the stream, finding any code at its very end. The scanner can then start a new stream.
+ * @return number of codes found, or -1 if the arguments are not valid
+ */
+int MultiCode_ScannerFinish(MultiCodeScanner scanner, MultiCodeScanCallback callback, void* context);
+
+/** Release a scanner */
+void MultiCode_ScannerDestroy(MultiCodeScanner* reference);
+
+// Syndrome tables
+//
+// Short codes with few correction symbols can be corrected by one table look-up, instead of
+// algebraic decoding. A table is built for each code length and correction symbol count when first
+// needed, then shared by every thread. Results are the same with or without tables.
+// Tables are off by default: set a memory limit to use them.
+//
+// Building a table runs the algebraic decoder once for every entry, and takes longer for longer codes.
+// For codes of about 20 symbols it takes:
+//   1 to 3 correction symbols   under 0.01s
+//   4 correction symbols        about 0.1s
+//   5 correction symbols        about 1.5s
+//   6 correction symbols        about 25s
+// Tables for up to 5 correction symbols are built when first needed, by whichever decode needs one.
+// Tables for 6 are only built by MultiCode_SyndromeTableBuild or MultiCode_PlanCreate.
+
+/**
+ * Set the memory that syndrome tables may use in total. Zero turns them off, and is the default.
+ * Each table takes 8 * 16^correctionSymbols bytes: 512KB for 4 correction symbols, 8MB for 5, 128MB for 6.
+ * Shapes whose table won't fit in what is left, or with more than 6 correction symbols or
+ * codes over 64 symbols long, use algebraic decoding. Tables already built are kept.
+ * @param bytes memory limit
+ * @return previous limit
+ */
+size_t MultiCode_SyndromeTableLimit(size_t bytes);
+
+/**
+ * Build the syndrome table for a shape of code now, rather than on its first correction.
+ * This is done by MultiCode_PlanCreate too, and is the only way to get a table for 6 correction symbols.
+ * It can take some time: see the build costs above.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @return non-zero if the table is ready
+ */
+int MultiCode_SyndromeTableBuild(int dataLength, int correctionSymbols);
+
+/**
+ * Length of the string made by encoding, not including the terminator
+ * @param dataLength number of bytes in data
+ * @param correctionSymbols count of correction symbols to add
+ */
+int MultiCode_EncodedLength(int dataLength, int correctionSymbols);
+
+/**
+ * Read a monotonic clock, for setting decode deadlines
+ * @return nanoseconds from an arbitrary starting point
+ */
+long long MultiCode_MonotonicNanos(void);
+
+/**
+ * Check a multi-code string without decoding or correcting it.
+ * This does not allocate memory.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @return MultiCode_Clean if the code has no errors, MultiCode_NeedsCorrection if it
+ *         has errors that MultiCode_Decode may be able to fix, or MultiCode_Invalid.
+ */
+MultiCodeStatus MultiCode_Check(const char* code, int dataLength, int correctionSymbols);
+
+/**
+ * Decode a multi-code string that has no errors. No corrections are attempted.
+ * This does not allocate memory.
+ * @param code pointer to null-terminated string. This is the end-user input.
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @param output buffer of at least 'dataLength' bytes to receive the data. Contents are undefined if the code is not clean.
+ * @return MultiCode_Clean if data was written to output, otherwise as for MultiCode_Check
+ */
+MultiCodeStatus MultiCode_DecodeClean(const char* code, int dataLength, int correctionSymbols, void* output);
+
+/**
+ * Decode many multi-code strings that all have the same data length and correction symbols.
+ * Codes are checked in blocks of 16, and only codes with errors go through full correction.
+ * This is much faster than MultiCode_Decode when most codes are correct.
+ * @param codes array of pointers to null-terminated strings. These are the end-user inputs.
+ * @param count number of codes
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to codes
+ * @param output buffer of 'count * dataLength' bytes. Data for code 'i' starts at 'i * dataLength'
+ * @param statuses optional array of 'count' results. MultiCode_Clean or MultiCode_Corrected where data
+ *        was recovered, MultiCode_Invalid where it was not.
+ * @return number of codes decoded, or -1 if the batch could not be started
+ */
+int MultiCode_DecodeBatch(const char* const* codes, int count, int dataLength, int correctionSymbols,
+                          void* output, MultiCodeStatus* statuses);
+
+/**
+ * Encode many payloads of the same length to multi-code strings.
+ * Payloads are encoded 64 at a time with a bit-sliced Reed-Solomon encoder.
+ * Output is the same as calling MultiCode_Encode for each payload.
+ * @param sources array of pointers to data, each 'sourceLength' bytes
+ * @param count number of payloads
+ * @param sourceLength number of bytes in each payload
+ * @param correctionSymbols count of correction symbols to add
+ * @param outputs array of 'count' pointers, set to null-terminated strings, or NULL where a payload
+ *        could not be encoded. Free each after use.
+ * @return number of payloads encoded, or -1 if the batch could not be started
+ */
+int MultiCode_EncodeBatch(const void* const* sources, int count, int sourceLength, int correctionSymbols, char** outputs);
+
+#ifdef MULTICODE_HISTOGRAMS
+// Optional per-thread latency histograms for each decode phase.
+// Each thread records into its own histogram, so recording takes no locks.
+// Without MULTICODE_HISTOGRAMS defined, none of this is compiled in.
+
+/** Decode phases with latency histograms */
+typedef enum MultiCodePhase {
+    MultiCode_PhaseClassify    = 0, //!< character classification and normalisation
+    MultiCode_PhaseRepair      = 1, //!< chirality repair
+    MultiCode_PhaseFirstDecode = 2, //!< first Reed-Solomon decode
+    MultiCode_PhaseRotations   = 3, //!< rotation retries after the first decode fails
+    MultiCode_PhaseBytes       = 4, //!< rebuilding data bytes from symbols
+    MultiCode_PhaseCount       = 5
+} MultiCodePhase;
+
+/** Number of histogram buckets: four per power of two nanoseconds */
+#define MULTICODE_HISTOGRAM_BUCKETS 256
+
+/** Count of phase durations in each bucket */
+typedef struct MultiCodeHistogram {
+    unsigned long long counts[MultiCode_PhaseCount][MULTICODE_HISTOGRAM_BUCKETS];
+} MultiCodeHistogram;
+
+/**
+ * Add the decode phase histograms of every thread into 'target'.
+ * Start with a zeroed histogram to get totals. Counts from threads that are still decoding may be slightly behind.
+ */
+void MultiCode_HistogramMerge(MultiCodeHistogram* target);
+
+/** Smallest duration in nanoseconds that is counted in a histogram bucket */
+unsigned long long MultiCode_HistogramBucketStart(int bucket);
+
+/**
+ * Write histograms as text: a heading for each phase, then one line per non-empty bucket
+ * with bucket start in nanoseconds and count.
+ * @return length of full text, not including the terminator. If this is 'size' or more, the output was cut short.
+ */
+int MultiCode_HistogramText(const MultiCodeHistogram* histogram, char* buffer, int size);
+
+/**
+ * Write histograms as JSON: an object of phase names, each an array of [bucket start ns, count] pairs.
+ * @return length of full text, not including the terminator. If this is 'size' or more, the output was cut short.
+ */
+int MultiCode_HistogramJson(const MultiCodeHistogram* histogram, char* buffer, int size);
+#endif
+
 #endif //C99_MULTICODE_H
\ No newline at end of file
@@ -0,0 +1,156 @@
+// ReSharper disable CppParameterMayBeConst
+// ReSharper disable CppLocalVariableMayBeConst
+#define _POSIX_C_SOURCE 200809L
+
+#include "MultiCodeService.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/** Connection to a decode service */
+typedef struct MultiCodeClientObj {
+    int fd;
+} MultiCodeClientObj;
+
+/** Write all bytes, retrying on partial writes. Returns zero on success */
+int cli_WriteAll(int fd, const unsigned char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = write(fd, data, length);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return -1;
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 0;
+}
+
+/** Read exactly 'length' bytes. Returns zero on success */
+int cli_ReadAll(int fd, unsigned char* data, size_t length) {
+    while (length > 0) {
+        ssize_t count = read(fd, data, length);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return -1;
+        data += count;
+        length -= (size_t)count;
+    }
+    return 0;
+}
+
+/**
+ * Connect to a decode service
+ * @param socketPath file system path for the socket
+ * @return client connection, or NULL on failure. Close this after use.
+ */
+MultiCodeClient MultiCodeClient_Connect(const char* socketPath) {
+    if (socketPath == NULL) return NULL;
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) return NULL;
+    strcpy(address.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    MultiCodeClient client = calloc(1, sizeof(MultiCodeClientObj));
+    if (client == NULL) {
+        close(fd);
+        return NULL;
+    }
+
+    client->fd = fd;
+    return client;
+}
+
+/** Close a client connection */
+void MultiCodeClient_Close(MultiCodeClient* reference) {
+    if (reference == NULL || *reference == NULL) return;
+    close((*reference)->fd);
+    free(*reference);
+    *reference = NULL;
+}
+
+/**
+ * Send a decode request without waiting for the response.
+ * @return zero on success, -1 if the connection failed
+ */
+int MultiCodeClient_Send(MultiCodeClient client, uint32_t id, const char* code, int codeLength,
+                         int dataLength, int correctionSymbols) {
+    if (client == NULL || code == NULL) return -1;
+    if (codeLength < 0 || codeLength > 0xFFFF) return -1;
+    if (dataLength < 0 || dataLength > 0xFFFF || correctionSymbols < 0 || correctionSymbols > 0xFF) return -1;
+
+    unsigned char header[MULTICODE_REQUEST_HEADER];
+    header[0] = (unsigned char)(id & 0xFF);
+    header[1] = (unsigned char)((id >> 8) & 0xFF);
+    header[2] = (unsigned char)((id >> 16) & 0xFF);
+    header[3] = (unsigned char)((id >> 24) & 0xFF);
+    header[4] = (unsigned char)correctionSymbols;
+    header[5] = 0;
+    header[6] = (unsigned char)(dataLength & 0xFF);
+    header[7] = (unsigned char)((dataLength >> 8) & 0xFF);
+    header[8] = (unsigned char)(codeLength & 0xFF);
+    header[9] = (unsigned char)((codeLength >> 8) & 0xFF);
+
+    if (cli_WriteAll(client->fd, header, sizeof(header)) < 0) return -1;
+    return cli_WriteAll(client->fd, (const unsigned char*)code, (size_t)codeLength);
+}
+
+/**
+ * Wait for the next response
+ * @return status of decode, or MultiCode_Invalid if the connection failed
+ */
+MultiCodeStatus MultiCodeClient_Receive(MultiCodeClient client, uint32_t* id, void* output, int outputLength) {
+    if (client == NULL) return MultiCode_Invalid;
+
+    unsigned char header[MULTICODE_RESPONSE_HEADER];
+    if (cli_ReadAll(client->fd, header, sizeof(header)) < 0) return MultiCode_Invalid;
+
+    if (id != NULL) {
+        *id = (uint32_t)header[0] | ((uint32_t)header[1] << 8) | ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+    }
+    MultiCodeStatus status = (MultiCodeStatus)(signed char)header[4];
+    int dataLength         = header[6] | (header[7] << 8);
+
+    // Read data, discarding anything that doesn't fit
+    unsigned char discard[256];
+    unsigned char* target = output;
+    while (dataLength > 0) {
+        if (target != NULL && outputLength > 0) {
+            int count = dataLength < outputLength ? dataLength : outputLength;
+            if (cli_ReadAll(client->fd, target, (size_t)count) < 0) return MultiCode_Invalid;
+            target += count;
+            outputLength -= count;
+            dataLength -= count;
+        } else {
+            int count = dataLength < (int)sizeof(discard) ? dataLength : (int)sizeof(discard);
+            if (cli_ReadAll(client->fd, discard, (size_t)count) < 0) return MultiCode_Invalid;
+            dataLength -= count;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Decode a null-terminated code using the service, and wait for the result
+ * @return status of decode, or MultiCode_Invalid if the connection failed
+ */
+MultiCodeStatus MultiCodeClient_Decode(MultiCodeClient client, const char* code, int dataLength,
+                                       int correctionSymbols, void* output) {
+    if (code == NULL) return MultiCode_Invalid;
+    if (MultiCodeClient_Send(client, 0, code, (int)strlen(code), dataLength, correctionSymbols) < 0) {
+        return MultiCode_Invalid;
+    }
+    return MultiCodeClient_Receive(client, NULL, output, dataLength);
+}
@@ -0,0 +1,463 @@
+// ReSharper disable CppParameterMayBeConst
+// ReSharper disable CppLocalVariableMayBeConst
+#define _POSIX_C_SOURCE 200809L
+
+#include "MultiCodeService.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#pragma region Buffers
+
+/** Growable byte buffer for socket input and output */
+typedef struct svc_Buffer {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} svc_Buffer;
+
+/** Make sure there is space for 'extra' more bytes. Returns zero on failure */
+int svc_Reserve(svc_Buffer* buffer, size_t extra) {
+    if (buffer->length + extra <= buffer->capacity) return 1;
+
+    size_t capacity = buffer->capacity < 256 ? 256 : buffer->capacity;
+    while (capacity < buffer->length + extra) capacity *= 2;
+
+    unsigned char* data = realloc(buffer->data, capacity);
+    if (data == NULL) return 0;
+
+    buffer->data     = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+/** Remove 'count' bytes from the front of the buffer */
+void svc_Consume(svc_Buffer* buffer, size_t count) {
+    if (count >= buffer->length) {
+        buffer->length = 0;
+        return;
+    }
+    memmove(buffer->data, buffer->data + count, buffer->length - count);
+    buffer->length -= count;
+}
+
+uint16_t svc_Read16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t svc_Read32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#pragma endregion Buffers
+
+#pragma region Connections
+
+/** One client connection */
+typedef struct svc_Connection {
+    int fd;
+    svc_Buffer in;
+    svc_Buffer out;
+    int eof;      //!< peer has finished sending. Close once output is sent.
+    int closed;   //!< connection failed, or is finished
+    int events;   //!< events registered with epoll
+    struct svc_Connection* next;
+} svc_Connection;
+
+/** A request waiting in the current batch */
+typedef struct svc_Request {
+    svc_Connection* connection;
+    uint32_t id;
+    int dataLength;
+    int correctionSymbols;
+    size_t codeOffset;   //!< null-terminated copy of code in the batch's code buffer
+    size_t dataOffset;   //!< decoded data in the batch's output buffer
+    MultiCodeStatus status;
+    int rejected;        //!< request can't be decoded, and will get an invalid response
+    int done;
+} svc_Request;
+
+/** Requests gathered across all readable connections */
+typedef struct svc_Batch {
+    svc_Request requests[MULTICODE_SERVICE_MAX_BATCH];
+    int count;
+    svc_Buffer codes;  //!< null-terminated codes for the batch
+    svc_Buffer output; //!< decoded data for the batch
+} svc_Batch;
+
+int svc_SetNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/**
+ * True if the connection has a full input buffer, or output the client has not collected.
+ * No more input is read or parsed until this clears, so one client can't grow memory without limit.
+ */
+int svc_Backlogged(const svc_Connection* connection) {
+    return connection->in.length >= MULTICODE_SERVICE_MAX_BUFFER
+           || connection->out.length >= MULTICODE_SERVICE_MAX_BUFFER;
+}
+
+/** Write as much pending output as the socket will take, and update the events we wait for */
+void svc_Flush(int epoll, svc_Connection* connection) {
+    while (connection->out.length > 0 && !connection->closed) {
+        ssize_t sent = write(connection->fd, connection->out.data, connection->out.length);
+        if (sent > 0) {
+            svc_Consume(&connection->out, (size_t)sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        connection->closed = -1;
+        return;
+    }
+
+    int events = (connection->eof || svc_Backlogged(connection) ? 0 : EPOLLIN)
+                 | (connection->out.length > 0 ? EPOLLOUT : 0);
+    if (events == connection->events) return;
+
+    struct epoll_event event;
+    event.events   = (uint32_t)events;
+    event.data.ptr = connection;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, connection->fd, &event);
+    connection->events = events;
+}
+
+/** Append a response frame to the connection's output */
+void svc_Respond(svc_Connection* connection, uint32_t id, MultiCodeStatus status,
+                 const unsigned char* data, int dataLength) {
+    if (connection->closed) return;
+    if (status == MultiCode_Invalid) dataLength = 0;
+
+    if (!svc_Reserve(&connection->out, MULTICODE_RESPONSE_HEADER + (size_t)dataLength)) {
+        connection->closed = -1;
+        return;
+    }
+
+    unsigned char* p = connection->out.data + connection->out.length;
+    p[0] = (unsigned char)(id & 0xFF);
+    p[1] = (unsigned char)((id >> 8) & 0xFF);
+    p[2] = (unsigned char)((id >> 16) & 0xFF);
+    p[3] = (unsigned char)((id >> 24) & 0xFF);
+    p[4] = (unsigned char)(signed char)status;
+    p[5] = 0;
+    p[6] = (unsigned char)(dataLength & 0xFF);
+    p[7] = (unsigned char)((dataLength >> 8) & 0xFF);
+    if (dataLength > 0) memcpy(p + MULTICODE_RESPONSE_HEADER, data, (size_t)dataLength);
+
+    connection->out.length += MULTICODE_RESPONSE_HEADER + (size_t)dataLength;
+}
+
+#pragma endregion Connections
+
+#pragma region Batching
+
+/**
+ * Decode every request in the batch with MultiCode_DecodeBatch, one call per shape,
+ * then queue the responses in the order requests arrived.
+ */
+void svc_RunBatch(int epoll, svc_Batch* batch) {
+    if (batch->count < 1) return;
+
+    const char* codes[MULTICODE_SERVICE_MAX_BATCH];
+    int members[MULTICODE_SERVICE_MAX_BATCH];
+    MultiCodeStatus statuses[MULTICODE_SERVICE_MAX_BATCH];
+
+    size_t outputSize = 0;
+    for (int i = 0; i < batch->count; i++) {
+        svc_Request* request = &batch->requests[i];
+        request->done = request->rejected;
+        if (request->rejected) request->status = MultiCode_Invalid;
+        else outputSize += (size_t)request->dataLength;
+    }
+
+    batch->output.length = 0;
+    int haveOutput = svc_Reserve(&batch->output, outputSize);
+
+    size_t groupStart = 0;
+    for (int i = 0; i < batch->count && haveOutput; i++) {
+        svc_Request* first = &batch->requests[i];
+        if (first->done) continue;
+
+        // Gather all requests with the same shape
+        int count = 0;
+        for (int j = i; j < batch->count; j++) {
+            svc_Request* other = &batch->requests[j];
+            if (other->done || other->dataLength != first->dataLength
+                || other->correctionSymbols != first->correctionSymbols) continue;
+
+            other->done       = -1;
+            other->dataOffset = groupStart + (size_t)count * (size_t)first->dataLength;
+            members[count]    = j;
+            codes[count]      = (const char*)batch->codes.data + other->codeOffset;
+            count++;
+        }
+
+        if (MultiCode_DecodeBatch(codes, count, first->dataLength, first->correctionSymbols,
+                                  batch->output.data + groupStart, statuses) < 0) {
+            for (int k = 0; k < count; k++) statuses[k] = MultiCode_Invalid;
+        }
+
+        for (int k = 0; k < count; k++) batch->requests[members[k]].status = statuses[k];
+        groupStart += (size_t)count * (size_t)first->dataLength;
+    }
+
+    for (int i = 0; i < batch->count; i++) {
+        svc_Request* request = &batch->requests[i];
+        if (!haveOutput) request->status = MultiCode_Invalid;
+        if (request->status == MultiCode_Invalid) {
+            svc_Respond(request->connection, request->id, MultiCode_Invalid, NULL, 0);
+        } else {
+            svc_Respond(request->connection, request->id, request->status,
+                        batch->output.data + request->dataOffset, request->dataLength);
+        }
+    }
+
+    for (int i = 0; i < batch->count; i++) {
+        svc_Flush(epoll, batch->requests[i].connection);
+    }
+
+    batch->count        = 0;
+    batch->codes.length = 0;
+}
+
+/**
+ * Move complete requests from a connection's input into the batch.
+ * Runs the batch early if it fills up. Stops while the client's responses are backed up,
+ * and closes the connection if a request is longer than any code the service accepts.
+ */
+void svc_ParseRequests(int epoll, svc_Connection* connection, svc_Batch* batch) {
+    size_t offset = 0;
+
+    while (!connection->closed && connection->in.length - offset >= MULTICODE_REQUEST_HEADER
+           && connection->out.length < MULTICODE_SERVICE_MAX_BUFFER) {
+        const unsigned char* p = connection->in.data + offset;
+        uint32_t id           = svc_Read32(p);
+        int correctionSymbols = p[4];
+        int dataLength        = svc_Read16(p + 6);
+        int codeLength        = svc_Read16(p + 8);
+
+        if (codeLength > MULTICODE_SERVICE_MAX_CODE) {
+            connection->closed = -1;
+            break;
+        }
+
+        size_t frameLength = MULTICODE_REQUEST_HEADER + (size_t)codeLength;
+        if (connection->in.length - offset < frameLength) break; // wait for rest of frame
+
+        if (batch->count >= MULTICODE_SERVICE_MAX_BATCH) svc_RunBatch(epoll, batch);
+
+        // Bad requests still go through the batch, to keep responses in order
+        svc_Request* request       = &batch->requests[batch->count++];
+        request->connection        = connection;
+        request->id                = id;
+        request->dataLength        = dataLength;
+        request->correctionSymbols = correctionSymbols;
+        request->codeOffset        = batch->codes.length;
+        request->rejected          = dataLength < 1 || dataLength > MULTICODE_SERVICE_MAX_DATA
+                                     || !svc_Reserve(&batch->codes, (size_t)codeLength + 1);
+
+        if (!request->rejected) {
+            // Copy code with a terminator.
+            char* code = (char*)batch->codes.data + batch->codes.length;
+            memcpy(code, p + MULTICODE_REQUEST_HEADER, (size_t)codeLength);
+            code[codeLength] = 0;
+            batch->codes.length += (size_t)codeLength + 1;
+        }
+
+        offset += frameLength;
+    }
+
+    svc_Consume(&connection->in, offset);
+}
+
+/** Read everything available on a connection, up to the input buffer limit */
+void svc_ReadConnection(svc_Connection* connection) {
+    while (!connection->closed && !connection->eof && !svc_Backlogged(connection)) {
+        if (!svc_Reserve(&connection->in, 4096)) {
+            connection->closed = -1;
+            return;
+        }
+
+        size_t space = connection->in.capacity - connection->in.length;
+        if (space > MULTICODE_SERVICE_MAX_BUFFER - connection->in.length) {
+            space = MULTICODE_SERVICE_MAX_BUFFER - connection->in.length;
+        }
+
+        ssize_t count = read(connection->fd, connection->in.data + connection->in.length, space);
+        if (count > 0) {
+            connection->in.length += (size_t)count;
+            continue;
+        }
+        if (count == 0) {
+            connection->eof = -1;
+            return;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) connection->closed = -1;
+        return;
+    }
+}
+
+#pragma endregion Batching
+
+/** Accept all waiting connections */
+void svc_Accept(int epoll, int listener, svc_Connection** connections) {
+    for (;;) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN, or out of descriptors
+        }
+
+        svc_Connection* connection = calloc(1, sizeof(svc_Connection));
+        if (connection == NULL || svc_SetNonBlocking(fd) < 0) {
+            free(connection);
+            close(fd);
+            continue;
+        }
+        connection->fd     = fd;
+        connection->events = EPOLLIN;
+
+        struct epoll_event event;
+        event.events   = EPOLLIN;
+        event.data.ptr = connection;
+        if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+            free(connection);
+            close(fd);
+            continue;
+        }
+
+        connection->next = *connections;
+        *connections     = connection;
+    }
+}
+
+/** Close and free connections that have failed, or have finished and sent all their responses */
+void svc_Reap(int epoll, svc_Connection** connections) {
+    svc_Connection** link = connections;
+    while (*link != NULL) {
+        svc_Connection* connection = *link;
+        if (connection->eof && connection->out.length == 0) connection->closed = -1;
+        if (!connection->closed) {
+            link = &connection->next;
+            continue;
+        }
+
+        *link = connection->next;
+        epoll_ctl(epoll, EPOLL_CTL_DEL, connection->fd, NULL);
+        close(connection->fd);
+        free(connection->in.data);
+        free(connection->out.data);
+        free(connection);
+    }
+}
+
+/** Make sure look-up tables are built before the first request arrives */
+void svc_WarmUp(void) {
+    unsigned char data[4] = {0};
+    char* code = MultiCode_Encode(data, 4, 4);
+    if (code == NULL) return;
+    MultiCode_Check(code, 4, 4);
+    free(MultiCode_Decode(code, 4, 4));
+    free(code);
+}
+
+/**
+ * Run a decode service on a Unix domain socket until 'stop' becomes non-zero.
+ * @param socketPath file system path for the socket
+ * @param stop flag to end the service
+ * @return zero on clean shut-down, or -1 if the service could not be started
+ */
+int MultiCodeService_Run(const char* socketPath, volatile int* stop) {
+    if (socketPath == NULL || stop == NULL) return -1;
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) return -1;
+    strcpy(address.sun_path, socketPath);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return -1;
+
+    unlink(socketPath);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) < 0
+        || listen(listener, 128) < 0
+        || svc_SetNonBlocking(listener) < 0) {
+        close(listener);
+        return -1;
+    }
+
+    int epoll = epoll_create1(0);
+    if (epoll < 0) {
+        close(listener);
+        unlink(socketPath);
+        return -1;
+    }
+
+    struct epoll_event event;
+    event.events   = EPOLLIN;
+    event.data.ptr = NULL; // NULL marks the listener
+    epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+
+    svc_WarmUp();
+
+    svc_Batch* batch = calloc(1, sizeof(svc_Batch));
+    svc_Connection* connections = NULL;
+    struct epoll_event events[64];
+
+    while (batch != NULL && !*stop) {
+        int ready = epoll_wait(epoll, events, 64, 250);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        // Gather requests from every ready connection into one batch
+        for (int i = 0; i < ready; i++) {
+            svc_Connection* connection = events[i].data.ptr;
+            if (connection == NULL) {
+                svc_Accept(epoll, listener, &connections);
+                continue;
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                svc_ReadConnection(connection);
+                svc_ParseRequests(epoll, connection, batch);
+                svc_Flush(epoll, connection); // stop waiting for input at end, or while backlogged
+            }
+            if (events[i].events & EPOLLOUT) {
+                // Responses draining can let parked input through
+                svc_Flush(epoll, connection);
+                svc_ParseRequests(epoll, connection, batch);
+                svc_Flush(epoll, connection);
+            }
+        }
+
+        svc_RunBatch(epoll, batch);
+        svc_Reap(epoll, &connections);
+    }
+
+    // Shut down
+    for (svc_Connection* c = connections; c != NULL; c = c->next) c->closed = -1;
+    svc_Reap(epoll, &connections);
+    if (batch != NULL) {
+        free(batch->codes.data);
+        free(batch->output.data);
+        free(batch);
+    }
+
+    close(epoll);
+    close(listener);
+    unlink(socketPath);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef C99_MULTICODE_SERVICE_H
+#define C99_MULTICODE_SERVICE_H
+
+#include <stdint.h>
+
+#include "MultiCode.h"
+
+// Optional decode service over a Unix domain socket.
+// Long-running processes keep tables warm, and gather pipelined requests into batches.
+//
+// All values are little-endian.
+//
+// Request frame:
+//   u32 id                 -- copied to response
+//   u8  correctionSymbols
+//   u8  reserved (zero)
+//   u16 dataLength         -- bytes in ORIGINAL data
+//   u16 codeLength         -- bytes of code that follow
+//   ... code bytes (no terminator)
+//
+// Response frame:
+//   u32 id
+//   i8  status             -- MultiCodeStatus
+//   u8  reserved (zero)
+//   u16 dataLength         -- bytes of data that follow. Zero if status is MultiCode_Invalid
+//   ... data bytes
+
+#define MULTICODE_REQUEST_HEADER 10
+#define MULTICODE_RESPONSE_HEADER 8
+
+/** Largest data length the service will decode */
+#define MULTICODE_SERVICE_MAX_DATA 1024
+
+/** Largest number of requests decoded together */
+#define MULTICODE_SERVICE_MAX_BATCH 256
+
+/** Longest code the service will accept, in bytes. Connections sending longer codes are closed */
+#define MULTICODE_SERVICE_MAX_CODE (4 * (2 * MULTICODE_SERVICE_MAX_DATA + 255))
+
+/** Bytes buffered for each connection in each direction before the service stops reading from it */
+#define MULTICODE_SERVICE_MAX_BUFFER (64 * 1024)
+
+/**
+ * Run a decode service on a Unix domain socket until 'stop' becomes non-zero.
+ * Any existing file at 'socketPath' is replaced, and removed again on exit.
+ * @param socketPath file system path for the socket
+ * @param stop flag to end the service, usually set by a signal handler
+ * @return zero on clean shut-down, or -1 if the service could not be started
+ */
+int MultiCodeService_Run(const char* socketPath, volatile int* stop);
+
+/** Connection to a decode service */
+typedef struct MultiCodeClientObj* MultiCodeClient;
+
+/**
+ * Connect to a decode service
+ * @param socketPath file system path for the socket
+ * @return client connection, or NULL on failure. Close this after use.
+ */
+MultiCodeClient MultiCodeClient_Connect(const char* socketPath);
+
+/** Close a client connection */
+void MultiCodeClient_Close(MultiCodeClient* reference);
+
+/**
+ * Send a decode request without waiting for the response.
+ * Many requests can be sent before reading responses. Responses come back in the same order.
+ * @param id caller's identifier, returned with the response
+ * @param code end-user input, not null-terminated
+ * @param codeLength number of bytes in 'code'
+ * @param dataLength number of bytes in ORIGINAL data
+ * @param correctionSymbols count of correction symbols added to code
+ * @return zero on success, -1 if the connection failed
+ */
+int MultiCodeClient_Send(MultiCodeClient client, uint32_t id, const char* code, int codeLength,
+                         int dataLength, int correctionSymbols);
+
+/**
+ * Wait for the next response
+ * @param id receives the identifier given to MultiCodeClient_Send
+ * @param output buffer for recovered data
+ * @param outputLength size of output buffer. Extra data is discarded.
+ * @return status of decode, or MultiCode_Invalid if the connection failed
+ */
+MultiCodeStatus MultiCodeClient_Receive(MultiCodeClient client, uint32_t* id, void* output, int outputLength);
+
+/**
+ * Decode a null-terminated code using the service, and wait for the result
+ * @param output buffer of at least 'dataLength' bytes
+ * @return status of decode, or MultiCode_Invalid if the connection failed
+ */
+MultiCodeStatus MultiCodeClient_Decode(MultiCodeClient client, const char* code, int dataLength,
+                                       int correctionSymbols, void* output);
+
+#endif //C99_MULTICODE_SERVICE_H
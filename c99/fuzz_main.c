@@ -0,0 +1,168 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Algorithmic-complexity fuzzer for decode.
+// The objective is decode time and allocation count, not crashes: inputs that reach a
+// new cost level are reported to libFuzzer as new coverage, so it keeps mutating them,
+// and every new worst case is saved to a directory of the slowest inputs found.
+//
+// Input layout:
+//   u8  dataLength         -- 1 to 32
+//   u8  correctionSymbols  -- 0 to 16
+//   ... code bytes, with no terminator
+//
+// Built with clang and MULTICODE_LIBFUZZER this is a libFuzzer target, for example:
+//   multicode_fuzz -max_len=512 corpus/
+// Otherwise it replays saved inputs and reports their cost:
+//   multicode_fuzz slowest/*
+
+/** Allocations made by the decoder. MultiCode.c is included below so ALLOCATE can be counted */
+static long long fz_allocations = 0;
+
+static void* fz_Allocate(size_t count, size_t size) {
+    fz_allocations++;
+    return calloc(count, size);
+}
+
+#define ALLOCATE fz_Allocate
+#define FREE free
+#include "MultiCode.c"
+
+/** Longest code passed to the decoder. Longer inputs are cut off here */
+#define FZ_MAX_CODE 4096
+
+/** Most look-alike combinations tried for each input */
+#define FZ_LOOKALIKE_ATTEMPTS 256
+
+/** Cost of decoding one input */
+typedef struct fz_Cost {
+    long long nanos;
+    long long allocations;
+} fz_Cost;
+
+/** Decode an input every way an untrusted code would be, and measure the cost */
+static fz_Cost fz_Run(const uint8_t* data, size_t size) {
+    fz_Cost cost = {0, 0};
+    if (size < 2) return cost;
+
+    int dataLength        = 1 + data[0] % 32;
+    int correctionSymbols = data[1] % 17;
+
+    static char code[FZ_MAX_CODE + 1];
+    size_t length = size - 2 < FZ_MAX_CODE ? size - 2 : FZ_MAX_CODE;
+    memcpy(code, data + 2, length);
+    code[length] = 0;
+
+    static char copy[FZ_MAX_CODE + 1];
+    memcpy(copy, code, length + 1);
+
+    long long allocationsBefore = fz_allocations;
+    long long start             = MultiCode_MonotonicNanos();
+
+    // Decoders may change the input they are given, so each gets its own copy
+    free(MultiCode_Decode(code, dataLength, correctionSymbols));
+    free(MultiCode_DecodeLookAlike(copy, dataLength, correctionSymbols, FZ_LOOKALIKE_ATTEMPTS));
+
+    cost.nanos       = MultiCode_MonotonicNanos() - start;
+    cost.allocations = fz_allocations - allocationsBefore;
+    return cost;
+}
+
+#ifdef MULTICODE_LIBFUZZER
+
+/** Index of highest set bit, or zero */
+static int fz_Log2(long long value) {
+    int result = 0;
+    while (value > 1) {
+        value >>= 1;
+        result++;
+    }
+    return result;
+}
+
+/** Save an input that is a new worst case, named by its cost */
+static void fz_SaveSlow(const char* kind, long long cost, const uint8_t* data, size_t size) {
+    const char* directory = getenv("MULTICODE_FUZZ_SLOWEST");
+    if (directory == NULL) directory = "slowest";
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s-%012lld", directory, kind, cost);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return;
+    fwrite(data, 1, size, file);
+    fclose(file);
+}
+
+/** Cost levels, as coverage. Each new power of two in time or allocations counts as a new feature */
+__attribute__((used, section("__libfuzzer_extra_counters")))
+static uint8_t fz_costCounters[128];
+
+static long long fz_worstNanos       = 0;
+static long long fz_worstAllocations = 0;
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    fz_Cost cost = fz_Run(data, size);
+
+    // Time is noisy, so it only counts in microseconds
+    fz_costCounters[fz_Log2(cost.allocations) & 63] = 1;
+    fz_costCounters[64 + (fz_Log2(cost.nanos / 1000) & 63)] = 1;
+
+    if (cost.allocations > fz_worstAllocations) {
+        fz_worstAllocations = cost.allocations;
+        fz_SaveSlow("allocations", cost.allocations, data, size);
+    }
+    if (cost.nanos > fz_worstNanos) { // re-measure, so one slow run from noise isn't kept
+        fz_Cost again = fz_Run(data, size);
+        if (again.nanos < cost.nanos) cost.nanos = again.nanos;
+        if (cost.nanos > fz_worstNanos) {
+            fz_worstNanos = cost.nanos;
+            fz_SaveSlow("nanos", cost.nanos, data, size);
+        }
+    }
+    return 0;
+}
+
+#else
+
+/** Replay saved inputs, printing the cost of each and the worst found */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("Usage: %s <input-file>...\r\n", argv[0]);
+        return 1;
+    }
+
+    static uint8_t buffer[FZ_MAX_CODE + 2];
+    fz_Cost worst = {0, 0};
+
+    for (int i = 1; i < argc; i++) {
+        FILE* file = fopen(argv[i], "rb");
+        if (file == NULL) {
+            printf("Can't read %s\r\n", argv[i]);
+            continue;
+        }
+        size_t size = fread(buffer, 1, sizeof(buffer), file);
+        fclose(file);
+
+        // Best of a few runs, to reduce timing noise
+        fz_Cost cost = fz_Run(buffer, size);
+        for (int r = 0; r < 4; r++) {
+            fz_Cost again = fz_Run(buffer, size);
+            if (again.nanos < cost.nanos) cost.nanos = again.nanos;
+        }
+
+        printf("%10.2f us %8lld allocations   %s\r\n", cost.nanos / 1000.0, cost.allocations, argv[i]);
+        if (cost.nanos > worst.nanos) worst.nanos = cost.nanos;
+        if (cost.allocations > worst.allocations) worst.allocations = cost.allocations;
+    }
+
+    printf("worst: %.2f us, %lld allocations\r\n", worst.nanos / 1000.0, worst.allocations);
+    return 0;
+}
+
+#endif
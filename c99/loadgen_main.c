@@ -0,0 +1,155 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "MultiCodeService.h"
+
+// Load generator for the decode service.
+// Measures latency of the same codes decoded in-process and through the service.
+
+static int64_t nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int compareLatency(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a;
+    int64_t y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char* name, int64_t* latencies, int count, int64_t elapsed) {
+    qsort(latencies, (size_t)count, sizeof(int64_t), compareLatency);
+    printf("%-12s %10.0f ops/sec   p50 %8.2f us   p99 %8.2f us   max %8.2f us\r\n", name,
+           count / (elapsed / 1e9),
+           latencies[count / 2] / 1000.0,
+           latencies[(count * 99) / 100] / 1000.0,
+           latencies[count - 1] / 1000.0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("Usage: %s <socket-path> [requests=100000] [pipeline=32] [dataLength=6] [correctionSymbols=6] [damaged%%=5]\r\n", argv[0]);
+        return 1;
+    }
+
+    const char* socketPath = argv[1];
+    int requests           = argc > 2 ? atoi(argv[2]) : 100000;
+    int pipeline           = argc > 3 ? atoi(argv[3]) : 32;
+    int dataLength         = argc > 4 ? atoi(argv[4]) : 6;
+    int correctionSymbols  = argc > 5 ? atoi(argv[5]) : 6;
+    int damagedPercent     = argc > 6 ? atoi(argv[6]) : 5;
+
+    if (requests < 1 || pipeline < 1 || dataLength < 1 || dataLength > MULTICODE_SERVICE_MAX_DATA
+        || correctionSymbols < 0 || correctionSymbols > 255) {
+        printf("Invalid arguments\r\n");
+        return 1;
+    }
+
+    // Prepare codes, with some damaged by a transposition
+    char** codes           = calloc((size_t)requests, sizeof(char*));
+    int64_t* latencies     = calloc((size_t)requests, sizeof(int64_t));
+    int64_t* sentAt        = calloc((size_t)requests, sizeof(int64_t));
+    unsigned char* data    = calloc((size_t)dataLength, 1);
+    unsigned char* output  = calloc((size_t)dataLength, 1);
+    unsigned char* expect  = calloc((size_t)requests, (size_t)dataLength + 1); // in-process results, and a 'decoded' flag
+    if (codes == NULL || latencies == NULL || sentAt == NULL || data == NULL || output == NULL || expect == NULL) {
+        printf("Out of memory\r\n");
+        return 1;
+    }
+
+    srand(1234);
+    for (int i = 0; i < requests; i++) {
+        for (int j = 0; j < dataLength; j++) data[j] = (unsigned char)rand();
+        codes[i] = MultiCode_Encode(data, dataLength, correctionSymbols);
+        if (codes[i] == NULL) {
+            printf("Encode failed\r\n");
+            return 1;
+        }
+        if (rand() % 100 < damagedPercent) {
+            char t      = codes[i][0];
+            codes[i][0] = codes[i][1];
+            codes[i][1] = t;
+        }
+    }
+
+    printf("%d requests, pipeline %d, %d bytes + %d symbols, %d%% damaged\r\n",
+           requests, pipeline, dataLength, correctionSymbols, damagedPercent);
+
+    // In-process baseline
+    int failures  = 0;
+    int64_t start = nowNanos();
+    for (int i = 0; i < requests; i++) {
+        int64_t t0 = nowNanos();
+        void* result = MultiCode_Decode(codes[i], dataLength, correctionSymbols);
+        latencies[i] = nowNanos() - t0;
+        if (result == NULL) {
+            failures++;
+        } else {
+            unsigned char* slot = expect + (size_t)i * (size_t)(dataLength + 1);
+            memcpy(slot, result, (size_t)dataLength);
+            slot[dataLength] = 1;
+        }
+        free(result);
+    }
+    report("in-process", latencies, requests, nowNanos() - start);
+
+    // Through the service, keeping 'pipeline' requests in flight
+    MultiCodeClient client = MultiCodeClient_Connect(socketPath);
+    if (client == NULL) {
+        printf("Could not connect to %s\r\n", socketPath);
+        return 1;
+    }
+
+    int serviceFailures = 0;
+    int mismatches      = 0;
+    int sent            = 0;
+    int received        = 0;
+    start = nowNanos();
+    while (received < requests) {
+        while (sent < requests && sent - received < pipeline) {
+            sentAt[sent] = nowNanos();
+            if (MultiCodeClient_Send(client, (uint32_t)sent, codes[sent], (int)strlen(codes[sent]),
+                                     dataLength, correctionSymbols) < 0) {
+                printf("Send failed\r\n");
+                return 1;
+            }
+            sent++;
+        }
+
+        uint32_t id = 0;
+        MultiCodeStatus status = MultiCodeClient_Receive(client, &id, output, dataLength);
+        if (id >= (uint32_t)requests) {
+            printf("Bad response\r\n");
+            return 1;
+        }
+        latencies[received] = nowNanos() - sentAt[id];
+        if (status == MultiCode_Invalid) serviceFailures++;
+
+        // Service must agree with in-process decode
+        unsigned char* slot = expect + (size_t)id * (size_t)(dataLength + 1);
+        if ((status != MultiCode_Invalid) != (slot[dataLength] != 0)
+            || (status != MultiCode_Invalid && memcmp(slot, output, (size_t)dataLength) != 0)) {
+            mismatches++;
+        }
+        received++;
+    }
+    report("service", latencies, requests, nowNanos() - start);
+
+    printf("failures: in-process %d, service %d. mismatched results: %d\r\n", failures, serviceFailures, mismatches);
+
+    MultiCodeClient_Close(&client);
+    for (int i = 0; i < requests; i++) free(codes[i]);
+    free(codes);
+    free(latencies);
+    free(sentAt);
+    free(data);
+    free(output);
+    free(expect);
+    return mismatches > 0;
+}
@@ -62,5 +62,15 @@ int main(void) {
 
     free(recovered);
     free(code);
+
+#ifdef MULTICODE_HISTOGRAMS
+    // Show where decode time went
+    static MultiCodeHistogram histogram;
+    MultiCode_HistogramMerge(&histogram);
+
+    char text[4096];
+    MultiCode_HistogramText(&histogram, text, sizeof(text));
+    printf("\r\n\r\nDecode phase timings:\r\n%s", text);
+#endif
     return 0;
 }
\ No newline at end of file
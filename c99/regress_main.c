@@ -0,0 +1,71 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MultiCode.h"
+
+// Regression cases for bugs that were found and fixed. Each case prints what went wrong, if anything.
+//
+//   multicode_regress
+
+/** Matches reported by a scanner */
+typedef struct rg_Matches {
+    int count;
+    MultiCodeScanMatch first;
+    uint8_t data[16];
+} rg_Matches;
+
+static int rg_Collect(const MultiCodeScanMatch* match, void* context) {
+    rg_Matches* matches = context;
+    if (matches->count++ == 0 && match->dataLength <= (int)sizeof(matches->data)) {
+        matches->first = *match;
+        memcpy(matches->data, match->data, (size_t)match->dataLength);
+    }
+    return 0;
+}
+
+/**
+ * A code whose first data byte is zero ends in a valid code of any format two symbols shorter with
+ * fewer correction symbols, such as a (6, 4) code in a (5, 8) one. The scanner must report the whole code.
+ * @return non-zero on failure
+ */
+static int rg_ScanLongestFormat(void) {
+    const MultiCodeFormat formats[] = {{4, 6}, {6, 4}, {5, 8}};
+    uint8_t data[5]                 = {0x00, 0x12, 0x34, 0x56, 0x78};
+
+    MultiCodeFormatSet set = MultiCode_FormatSetCreate(formats, 3);
+    MultiCodeScanner scanner = MultiCode_ScannerCreate(set, NULL, NULL);
+    char* code = MultiCode_Encode(data, 5, 8);
+    if (set == NULL || scanner == NULL || code == NULL) {
+        printf("Scan longest format: could not start\r\n");
+        return 1;
+    }
+
+    char text[128];
+    snprintf(text, sizeof(text), "ticket %s was closed", code);
+
+    rg_Matches matches = {0};
+    MultiCode_ScannerFeed(scanner, text, strlen(text), rg_Collect, &matches);
+    MultiCode_ScannerFinish(scanner, rg_Collect, &matches);
+
+    int failed = matches.count != 1 || matches.first.formatIndex != 2 || matches.first.offset != 7
+                 || matches.first.length != (int)strlen(code) || memcmp(matches.data, data, 5) != 0;
+    if (failed) {
+        printf("Scan longest format: %d matches, first format %d at %lld, length %d\r\n", matches.count,
+               matches.first.formatIndex, matches.first.offset, matches.first.length);
+    }
+
+    free(code);
+    MultiCode_ScannerDestroy(&scanner);
+    MultiCode_FormatSetDestroy(&set);
+    return failed;
+}
+
+int main(void) {
+    int failed = 0;
+    failed += rg_ScanLongestFormat();
+
+    printf(failed ? "FAILED\r\n" : "OK\r\n");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,37 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "MultiCodeService.h"
+
+static volatile int stopRequested = 0;
+
+static void onSignal(int signal) {
+    (void)signal;
+    stopRequested = 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("Usage: %s <socket-path>\r\n", argv[0]);
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("MultiCode decode service listening on %s\r\n", argv[1]);
+    if (MultiCodeService_Run(argv[1], &stopRequested) != 0) {
+        printf("Failed to start service\r\n");
+        return 1;
+    }
+
+    printf("Service stopped\r\n");
+    return 0;
+}
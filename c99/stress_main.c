@@ -0,0 +1,190 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MultiCode.h"
+
+// Multi-threaded decode stress test, built with ThreadSanitizer.
+// Decodes the same damaged and undamaged codes on 1, 2, 4 ... up to 64 threads, each with its own context.
+// Every result must match single-threaded MultiCode_Decode, and throughput should grow with the thread count
+// while there are free cores.
+//
+//   multicode_stress [decodesPerThread=20000] [maxThreads=64] [minEfficiency=0.5]
+//
+// Efficiency is throughput per thread, relative to one thread, for thread counts up to the number of cores.
+// Counts past that are reported, but not checked. Use a minimum efficiency of zero to only report.
+
+#define ST_CODES 512
+#define ST_MAX_DATA 16
+#define ST_MAX_THREADS 64
+
+/** One input and the single-threaded result for it */
+typedef struct st_Case {
+    char* code;
+    int dataLength;
+    int correctionSymbols;
+    int decoded;
+    uint8_t expect[ST_MAX_DATA];
+} st_Case;
+
+/** Work and results for one thread */
+typedef struct st_Worker {
+    pthread_t thread;
+    const st_Case* cases;
+    int decodes;
+    int first;       //!< index of first case, so threads don't all start on the same code
+    int mismatches;
+    int failed;      //!< context could not be created
+} st_Worker;
+
+static int64_t nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void* st_Run(void* argument) {
+    st_Worker* worker = argument;
+    MultiCodeContext context = MultiCode_ContextCreate();
+    if (context == NULL) {
+        worker->failed = -1;
+        return NULL;
+    }
+
+    uint8_t output[ST_MAX_DATA];
+    for (int i = 0; i < worker->decodes; i++) {
+        const st_Case* c = &worker->cases[(worker->first + i) % ST_CODES];
+        MultiCodeStatus status = MultiCode_ContextDecode(context, c->code, c->dataLength, c->correctionSymbols,
+                                                         NULL, output);
+        if ((status != MultiCode_Invalid) != (c->decoded != 0)
+            || (status != MultiCode_Invalid && memcmp(output, c->expect, (size_t)c->dataLength) != 0)) {
+            worker->mismatches++;
+        }
+    }
+
+    MultiCode_ContextDestroy(&context);
+    return NULL;
+}
+
+/** Damage a code the way people do: swap, drop or change a character */
+static void st_Damage(char* code) {
+    int length = (int)strlen(code);
+    if (length < 3) return;
+
+    int at = rand() % (length - 1);
+    switch (rand() % 3) {
+        case 0: {
+            char t       = code[at];
+            code[at]     = code[at + 1];
+            code[at + 1] = t;
+            break;
+        }
+        case 1:
+            memmove(code + at, code + at + 1, (size_t)(length - at));
+            break;
+        default:
+            code[at] = "01236789bGJNqXYZ45ACDEFHKMPRsTVW"[rand() % 32];
+            break;
+    }
+}
+
+int main(int argc, char** argv) {
+    int decodesPerThread = argc > 1 ? atoi(argv[1]) : 20000;
+    int maxThreads       = argc > 2 ? atoi(argv[2]) : ST_MAX_THREADS;
+    double minEfficiency = argc > 3 ? atof(argv[3]) : 0.5;
+
+    if (decodesPerThread < 1 || maxThreads < 1 || maxThreads > ST_MAX_THREADS) {
+        printf("Usage: %s [decodesPerThread=20000] [maxThreads=64] [minEfficiency=0.5]\r\n", argv[0]);
+        return 1;
+    }
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) cores = 1;
+
+    // Codes of several shapes. Half are damaged, and some of those won't decode.
+    static st_Case cases[ST_CODES];
+    uint8_t data[ST_MAX_DATA];
+    srand(1234);
+    for (int i = 0; i < ST_CODES; i++) {
+        st_Case* c           = &cases[i];
+        c->dataLength        = 1 + rand() % ST_MAX_DATA;
+        c->correctionSymbols = 2 + rand() % 7;
+        for (int j = 0; j < c->dataLength; j++) data[j] = (uint8_t)rand();
+
+        c->code = MultiCode_Encode(data, c->dataLength, c->correctionSymbols);
+        if (c->code == NULL) {
+            printf("Encode failed\r\n");
+            return 1;
+        }
+        if (i & 1) st_Damage(c->code);
+
+        uint8_t* result = MultiCode_Decode(c->code, c->dataLength, c->correctionSymbols);
+        c->decoded = result != NULL;
+        if (result != NULL) memcpy(c->expect, result, (size_t)c->dataLength);
+        free(result);
+    }
+
+    printf("%d codes, %d decodes per thread, %ld cores\r\n", ST_CODES, decodesPerThread, cores);
+
+    static st_Worker workers[ST_MAX_THREADS];
+    int failed           = 0;
+    double singleRate    = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        memset(workers, 0, sizeof(workers));
+        for (int t = 0; t < threads; t++) {
+            workers[t].cases   = cases;
+            workers[t].decodes = decodesPerThread;
+            workers[t].first   = (t * 97) % ST_CODES;
+        }
+
+        int64_t start = nowNanos();
+        int started   = 0;
+        for (; started < threads; started++) {
+            if (pthread_create(&workers[started].thread, NULL, st_Run, &workers[started]) != 0) break;
+        }
+#ifdef MULTICODE_HISTOGRAMS
+        // Merging while threads decode must be safe too
+        static MultiCodeHistogram histogram;
+        MultiCode_HistogramMerge(&histogram);
+#endif
+        for (int t = 0; t < started; t++) pthread_join(workers[t].thread, NULL);
+        int64_t elapsed = nowNanos() - start;
+
+        int mismatches = 0;
+        int contexts   = 0;
+        for (int t = 0; t < started; t++) {
+            mismatches += workers[t].mismatches;
+            if (workers[t].failed) contexts++;
+        }
+
+        double rate = (double)started * decodesPerThread / (elapsed / 1e9);
+        if (threads == 1) singleRate = rate;
+        int usable        = threads < cores ? threads : (int)cores;
+        double efficiency = rate / (singleRate * usable);
+        int checked       = threads <= cores && minEfficiency > 0;
+
+        printf("%3d threads %12.0f decodes/sec   efficiency %5.2f%s   mismatches %d\r\n",
+               threads, rate, efficiency, checked ? "" : " (not checked)", mismatches);
+
+        if (started < threads || contexts > 0) {
+            printf("Could not start %d threads\r\n", threads);
+            failed = -1;
+        }
+        if (mismatches > 0) failed = -1;
+        if (checked && efficiency < minEfficiency) {
+            printf("Throughput on %d threads is below %.2f of linear\r\n", threads, minEfficiency);
+            failed = -1;
+        }
+    }
+
+    for (int i = 0; i < ST_CODES; i++) free(cases[i].code);
+
+    printf(failed ? "FAILED\r\n" : "OK\r\n");
+    return failed ? 1 : 0;
+}
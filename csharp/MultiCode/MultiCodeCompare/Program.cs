@@ -0,0 +1,112 @@
+﻿using System.Diagnostics;
+using System.Globalization;
+using System.Text.Json;
+using MultiCode;
+
+// Comparison runner for the C# implementation.
+//   dotnet run -c Release --project MultiCodeCompare -- <vectors> [seconds=1]
+// Prints one line of JSON results.
+
+if (args.Length < 1) {
+    Console.WriteLine("Usage: MultiCodeCompare <vectors> [seconds=1]");
+    return 1;
+}
+
+var vectors = ReadVectors(args[0]);
+var seconds = args.Length > 1 ? double.Parse(args[1], CultureInfo.InvariantCulture) : 1.0;
+if (vectors.Count < 1) {
+    Console.WriteLine($"Can't read vectors from {args[0]}");
+    return 1;
+}
+
+// The decoder writes diagnostics to the console. Keep them out of the results.
+var stdout = Console.Out;
+Console.SetOut(TextWriter.Null);
+
+int encodeMismatches = 0, decodeMismatches = 0, exceptions = 0;
+var firstMismatch = "";
+for (var i = 0; i < vectors.Count; i++) {
+    var v = vectors[i];
+    if (MultiCoder.Encode(v.Data, v.Sym) != v.Code) {
+        encodeMismatches++;
+        if (firstMismatch == "") firstMismatch = $"encode line {i + 1}";
+    }
+
+    var got = Decode(v, ref exceptions);
+    var same = got is null ? v.Expect is null : v.Expect is not null && got.AsSpan().SequenceEqual(v.Expect);
+    if (!same) {
+        decodeMismatches++;
+        if (firstMismatch == "") firstMismatch = $"decode line {i + 1}";
+    }
+}
+var decodeExceptions = exceptions;
+
+var limit = TimeSpan.FromSeconds(seconds);
+
+long encodes = 0;
+var bytesBefore = GC.GetAllocatedBytesForCurrentThread();
+var timer = Stopwatch.StartNew();
+while (timer.Elapsed < limit) {
+    foreach (var v in vectors) MultiCoder.Encode(v.Data, v.Sym);
+    encodes += vectors.Count;
+}
+var encodeRate  = encodes / timer.Elapsed.TotalSeconds;
+var encodeBytes = (GC.GetAllocatedBytesForCurrentThread() - bytesBefore) / (double)encodes;
+
+long decodes = 0;
+bytesBefore = GC.GetAllocatedBytesForCurrentThread();
+timer.Restart();
+while (timer.Elapsed < limit) {
+    foreach (var v in vectors) Decode(v, ref exceptions);
+    decodes += vectors.Count;
+}
+var decodeRate  = decodes / timer.Elapsed.TotalSeconds;
+var decodeBytes = (GC.GetAllocatedBytesForCurrentThread() - bytesBefore) / (double)decodes;
+
+Console.SetOut(stdout);
+Console.WriteLine(JsonSerializer.Serialize(new Dictionary<string, object?> {
+    ["impl"]                 = "csharp",
+    ["vectors"]              = vectors.Count,
+    ["encode_ops_per_sec"]   = Math.Round(encodeRate),
+    ["decode_ops_per_sec"]   = Math.Round(decodeRate),
+    ["encode_allocs_per_op"] = null,
+    ["decode_allocs_per_op"] = null,
+    ["encode_bytes_per_op"]  = Math.Round(encodeBytes),
+    ["decode_bytes_per_op"]  = Math.Round(decodeBytes),
+    ["encode_mismatches"]    = encodeMismatches,
+    ["decode_mismatches"]    = decodeMismatches,
+    ["decode_exceptions"]    = decodeExceptions,
+    ["first_mismatch"]       = firstMismatch
+}));
+return 0;
+
+// Decode a vector's input. Returns null on failure. Exceptions are counted as failures
+static byte[]? Decode(Vector v, ref int exceptions)
+{
+    try {
+        var result = MultiCoder.Decode(v.Input, v.Data.Length, v.Sym);
+        return result.Length > 0 ? result : null;
+    }
+    catch (Exception) {
+        exceptions++;
+        return null;
+    }
+}
+
+// Read tab-separated vectors: data hex, symbols, code, input, expected hex or '-'
+static List<Vector> ReadVectors(string path)
+{
+    var vectors = new List<Vector>();
+    foreach (var line in File.ReadLines(path)) {
+        if (line.Length < 1 || line.StartsWith('#')) continue;
+        var fields = line.Split('\t');
+        if (fields.Length != 5) continue;
+
+        var expect = fields[4] == "-" ? null : Convert.FromHexString(fields[4]);
+        vectors.Add(new Vector(Convert.FromHexString(fields[0]), int.Parse(fields[1], CultureInfo.InvariantCulture),
+                               fields[2], fields[3], expect));
+    }
+    return vectors;
+}
+
+internal record Vector(byte[] Data, int Sym, string Code, string Input, byte[]? Expect);
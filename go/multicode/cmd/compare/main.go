@@ -0,0 +1,165 @@
+﻿// Comparison runner for the Go implementation.
+//
+//	go run ./cmd/compare <vectors> [seconds=1]
+//
+// Prints one line of JSON results.
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/hex"
+	"encoding/json"
+	"fmt"
+	"os"
+	"runtime"
+	"strconv"
+	"strings"
+	"time"
+
+	"multicode/pkg"
+)
+
+type vector struct {
+	data   []byte
+	sym    int
+	code   string
+	input  string
+	expect []byte // nil if decode should fail
+}
+
+// readVectors reads tab-separated vectors: data hex, symbols, code, input, expected hex or '-'
+func readVectors(path string) ([]vector, error) {
+	file, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+
+	var vectors []vector
+	scanner := bufio.NewScanner(file)
+	for scanner.Scan() {
+		line := strings.TrimRight(scanner.Text(), "\r\n")
+		if line == "" || strings.HasPrefix(line, "#") {
+			continue
+		}
+		fields := strings.Split(line, "\t")
+		if len(fields) != 5 {
+			continue
+		}
+		data, err := hex.DecodeString(fields[0])
+		if err != nil {
+			continue
+		}
+		sym, err := strconv.Atoi(fields[1])
+		if err != nil {
+			continue
+		}
+		var expect []byte
+		if fields[4] != "-" {
+			if expect, err = hex.DecodeString(fields[4]); err != nil {
+				continue
+			}
+		}
+		vectors = append(vectors, vector{data, sym, fields[2], fields[3], expect})
+	}
+	return vectors, scanner.Err()
+}
+
+// decode a vector's input, counting panics as failures
+func decode(v *vector, panics *int) (result []byte) {
+	defer func() {
+		if recover() != nil {
+			*panics++
+			result = nil
+		}
+	}()
+	result = pkg.Decode(v.input, len(v.data), v.sym)
+	if len(result) < 1 {
+		return nil
+	}
+	return result
+}
+
+func main() {
+	if len(os.Args) < 2 {
+		fmt.Printf("Usage: %s <vectors> [seconds=1]\n", os.Args[0])
+		os.Exit(1)
+	}
+
+	vectors, err := readVectors(os.Args[1])
+	if err != nil || len(vectors) < 1 {
+		fmt.Printf("Can't read vectors from %s\n", os.Args[1])
+		os.Exit(1)
+	}
+	seconds := 1.0
+	if len(os.Args) > 2 {
+		seconds, _ = strconv.ParseFloat(os.Args[2], 64)
+	}
+	limit := time.Duration(seconds * float64(time.Second))
+
+	encodeMismatches, decodeMismatches, panics := 0, 0, 0
+	firstMismatch := ""
+	for i := range vectors {
+		v := &vectors[i]
+		if pkg.Encode(v.data, v.sym) != v.code {
+			encodeMismatches++
+			if firstMismatch == "" {
+				firstMismatch = fmt.Sprintf("encode line %d", i+1)
+			}
+		}
+		if got := decode(v, &panics); (got == nil) != (v.expect == nil) || !bytes.Equal(got, v.expect) {
+			decodeMismatches++
+			if firstMismatch == "" {
+				firstMismatch = fmt.Sprintf("decode line %d", i+1)
+			}
+		}
+	}
+	decodePanics := panics
+
+	var before, after runtime.MemStats
+
+	runtime.ReadMemStats(&before)
+	encodes := 0
+	start := time.Now()
+	for time.Since(start) < limit {
+		for i := range vectors {
+			pkg.Encode(vectors[i].data, vectors[i].sym)
+		}
+		encodes += len(vectors)
+	}
+	encodeRate := float64(encodes) / time.Since(start).Seconds()
+	runtime.ReadMemStats(&after)
+	encodeAllocs := float64(after.Mallocs-before.Mallocs) / float64(encodes)
+	encodeBytes := float64(after.TotalAlloc-before.TotalAlloc) / float64(encodes)
+
+	runtime.ReadMemStats(&before)
+	decodes := 0
+	start = time.Now()
+	for time.Since(start) < limit {
+		for i := range vectors {
+			decode(&vectors[i], &panics)
+		}
+		decodes += len(vectors)
+	}
+	decodeRate := float64(decodes) / time.Since(start).Seconds()
+	runtime.ReadMemStats(&after)
+	decodeAllocs := float64(after.Mallocs-before.Mallocs) / float64(decodes)
+	decodeBytes := float64(after.TotalAlloc-before.TotalAlloc) / float64(decodes)
+
+	result, _ := json.Marshal(map[string]any{
+		"impl":                 "go",
+		"vectors":              len(vectors),
+		"encode_ops_per_sec":   int(encodeRate),
+		"decode_ops_per_sec":   int(decodeRate),
+		"encode_allocs_per_op": encodeAllocs,
+		"decode_allocs_per_op": decodeAllocs,
+		"encode_bytes_per_op":  int(encodeBytes),
+		"decode_bytes_per_op":  int(decodeBytes),
+		"encode_mismatches":    encodeMismatches,
+		"decode_mismatches":    decodeMismatches,
+		"decode_exceptions":    decodePanics,
+		"first_mismatch":       firstMismatch,
+	})
+	fmt.Println(string(result))
+}
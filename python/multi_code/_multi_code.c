@@ -0,0 +1,538 @@
+// CPython extension for MultiCode, built on the C implementation in c99/MultiCode.c.
+// Functions have the same names and arguments as multi_code.py, so either can be imported:
+//
+//     try:
+//         from _multi_code import multi_code_encode, multi_code_decode
+//     except ImportError:
+//         from multi_code import multi_code_encode, multi_code_decode
+//
+// Encoding, and decoding of undamaged codes, give the same results as multi_code.py.
+// Damaged codes can decode differently, as the C decoder has repairs that multi_code.py lacks.
+//
+// Batch functions copy their inputs, then release the GIL and split the work across threads.
+// Build with: python3 setup.py build_ext --inplace
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// MultiCode.c is included so the module builds from this one source, with the C directory on the include path
+#include "MultiCode.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/** Fewest codes given to each thread, so small batches don't pay for threads they can't use */
+#define PMC_CODES_PER_THREAD 256
+
+/** Most threads used by one batch */
+#define PMC_MAX_THREADS 64
+
+/** Stands in for characters that multi_code.py reads as broken, but C would read differently */
+#define PMC_BROKEN_CHAR '!'
+
+#pragma region Inputs
+
+/**
+ * Append one code from a str to 'buffer', null-terminated, reading characters as multi_code.py does.
+ * Non-ASCII characters are read by their upper case, as Python's str.upper() gives it, or as broken.
+ * An embedded NUL ends the code, as it does in both implementations.
+ * Returns 0, or -1 with a Python exception set.
+ */
+static int pmc_ReadCode(PyObject* code, char* buffer, Py_ssize_t* used) {
+    if (!PyUnicode_Check(code)) {
+        PyErr_Format(PyExc_TypeError, "code must be str, not %.100s", Py_TYPE(code)->tp_name);
+        return -1;
+    }
+
+    Py_ssize_t length = PyUnicode_GET_LENGTH(code);
+    int kind          = PyUnicode_KIND(code);
+    const void* data  = PyUnicode_DATA(code);
+    char* out         = buffer + *used;
+
+    for (Py_ssize_t i = 0; i < length; i++) {
+        Py_UCS4 c = PyUnicode_READ(kind, data, i);
+        if (c == 0) break;
+        if (c < 128) {
+            *out++ = (char)c;
+            continue;
+        }
+
+        // Rare: a few characters have ASCII upper cases, like dotless i
+        char replacement = PMC_BROKEN_CHAR;
+        PyObject* single = PyUnicode_FromOrdinal((int)c);
+        PyObject* upper  = single == NULL ? NULL : PyObject_CallMethod(single, "upper", NULL);
+        Py_XDECREF(single);
+        if (upper == NULL) return -1;
+        if (PyUnicode_GET_LENGTH(upper) == 1 && PyUnicode_READ_CHAR(upper, 0) < 128) {
+            replacement = (char)PyUnicode_READ_CHAR(upper, 0);
+        }
+        Py_DECREF(upper);
+        *out++ = replacement;
+    }
+
+    *out++ = 0;
+    *used  = out - buffer;
+    return 0;
+}
+
+/** Space needed to hold a code from pmc_ReadCode, including the terminator */
+static Py_ssize_t pmc_CodeSpace(PyObject* code) {
+    return PyUnicode_Check(code) ? PyUnicode_GET_LENGTH(code) + 1 : 1;
+}
+
+/** Check sizes fit the C API */
+static int pmc_CheckLengths(Py_ssize_t dataLength, int correctionSymbols) {
+    if (dataLength < 0 || dataLength > INT_MAX / 4 || correctionSymbols < 0 || correctionSymbols > INT_MAX / 4) {
+        PyErr_SetString(PyExc_ValueError, "data length and correction symbols must be small non-negative integers");
+        return -1;
+    }
+    return 0;
+}
+
+/** Decoded result as multi_code.py gives it: a bytearray, or an empty list on failure */
+static PyObject* pmc_DecodeResult(const uint8_t* data, int dataLength, int ok) {
+    if (!ok || dataLength < 1) return PyList_New(0);
+    return PyByteArray_FromStringAndSize((const char*)data, dataLength);
+}
+
+/**
+ * Code for empty data, which is all zero symbols. The C encoder has no empty input, but multi_code.py does.
+ * Returns a new str, or NULL with a Python exception set.
+ */
+static PyObject* pmc_EmptyCode(int correctionSymbols) {
+    char* code = PyMem_Malloc((size_t)correctionSymbols * 2 + 1);
+    if (code == NULL) return PyErr_NoMemory();
+
+    int length = 0;
+    for (int i = 0; i < correctionSymbols; i++) {
+        if (i > 0 && i % 2 == 0) code[length++] = i % 4 == 0 ? '-' : ' ';
+        code[length++] = (i & 1) ? '4' : '0';
+    }
+
+    PyObject* result = PyUnicode_FromStringAndSize(code, length);
+    PyMem_Free(code);
+    return result;
+}
+
+#pragma endregion Inputs
+
+#pragma region Threads
+
+/** One thread's share of a batch */
+typedef struct pmc_Slice {
+    int first;                       //!< index of first item
+    int count;                       //!< number of items
+    int dataLength;
+    int correctionSymbols;
+    const char* const* codes;        //!< decode: null-terminated inputs. NULL for encode
+    const void* const* sources;      //!< encode: payloads. NULL for decode
+    uint8_t* output;                 //!< decode: 'dataLength' bytes per code
+    MultiCodeStatus* statuses;       //!< decode: result per code
+    char** encoded;                  //!< encode: string per payload, freed by the caller
+} pmc_Slice;
+
+static void pmc_RunSlice(pmc_Slice* slice) {
+    if (slice->codes != NULL) {
+        int decoded = MultiCode_DecodeBatch(slice->codes + slice->first, slice->count, slice->dataLength,
+                                            slice->correctionSymbols,
+                                            slice->output + (size_t)slice->first * (size_t)slice->dataLength,
+                                            slice->statuses + slice->first);
+        if (decoded < 0) {
+            for (int i = 0; i < slice->count; i++) slice->statuses[slice->first + i] = MultiCode_Invalid;
+        }
+    } else {
+        MultiCode_EncodeBatch(slice->sources + slice->first, slice->count, slice->dataLength,
+                              slice->correctionSymbols, slice->encoded + slice->first);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI pmc_ThreadMain(LPVOID slice) {
+    pmc_RunSlice((pmc_Slice*)slice);
+    return 0;
+}
+#else
+static void* pmc_ThreadMain(void* slice) {
+    pmc_RunSlice((pmc_Slice*)slice);
+    return NULL;
+}
+#endif
+
+/** Number of processors available, or 1 if not known */
+static int pmc_ProcessorCount(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+/**
+ * Split a batch across threads and wait for them all. Call without the GIL.
+ * 'threads' is the most threads to use, or zero for one per processor.
+ * Slices that can't get a thread are run on the calling thread.
+ */
+static void pmc_RunBatch(pmc_Slice batch, int count, int threads) {
+    if (threads < 1) threads = pmc_ProcessorCount();
+    if (threads > PMC_MAX_THREADS) threads = PMC_MAX_THREADS;
+    int useful = (count + PMC_CODES_PER_THREAD - 1) / PMC_CODES_PER_THREAD;
+    if (threads > useful) threads = useful;
+    if (threads < 1) threads = 1;
+
+    pmc_Slice slices[PMC_MAX_THREADS];
+#if defined(_WIN32)
+    HANDLE handles[PMC_MAX_THREADS];
+#else
+    pthread_t handles[PMC_MAX_THREADS];
+#endif
+    int started[PMC_MAX_THREADS] = {0};
+
+    int first = 0;
+    for (int t = 0; t < threads; t++) {
+        slices[t]       = batch;
+        slices[t].first = first;
+        slices[t].count = count / threads + (t < count % threads ? 1 : 0);
+        first += slices[t].count;
+    }
+
+    // The calling thread takes the first slice
+    for (int t = 1; t < threads; t++) {
+#if defined(_WIN32)
+        handles[t] = CreateThread(NULL, 0, pmc_ThreadMain, &slices[t], 0, NULL);
+        started[t] = handles[t] != NULL;
+#else
+        started[t] = pthread_create(&handles[t], NULL, pmc_ThreadMain, &slices[t]) == 0;
+#endif
+    }
+    pmc_RunSlice(&slices[0]);
+
+    for (int t = 1; t < threads; t++) {
+        if (!started[t]) {
+            pmc_RunSlice(&slices[t]);
+            continue;
+        }
+#if defined(_WIN32)
+        WaitForSingleObject(handles[t], INFINITE);
+        CloseHandle(handles[t]);
+#else
+        pthread_join(handles[t], NULL);
+#endif
+    }
+}
+
+#pragma endregion Threads
+
+#pragma region Functions
+
+PyDoc_STRVAR(pmc_encode_doc,
+"multi_code_encode(source, correction_symbols)\n--\n\n"
+"Encode binary data to a multi-code string.\n"
+"source: bytes-like data to be encoded\n"
+"correction_symbols: count of correction symbols to add\n"
+"Returns the multi-code for the source data.");
+
+static PyObject* pmc_Encode(PyObject* self, PyObject* args) {
+    Py_buffer source;
+    int correctionSymbols;
+    if (!PyArg_ParseTuple(args, "y*i:multi_code_encode", &source, &correctionSymbols)) return NULL;
+
+    PyObject* result = NULL;
+    if (pmc_CheckLengths(source.len, correctionSymbols) == 0) {
+        if (source.len == 0) {
+            result = pmc_EmptyCode(correctionSymbols);
+        } else {
+            char* code = MultiCode_Encode(source.buf, (int)source.len, correctionSymbols);
+            if (code == NULL) PyErr_NoMemory();
+            else result = PyUnicode_FromString(code);
+            free(code);
+        }
+    }
+
+    PyBuffer_Release(&source);
+    return result;
+}
+
+PyDoc_STRVAR(pmc_decode_doc,
+"multi_code_decode(code, data_length, correction_symbols)\n--\n\n"
+"Decode a multi-code string to binary data.\n"
+"code: the end-user input\n"
+"data_length: number of bytes in ORIGINAL data\n"
+"correction_symbols: count of correction symbols added to code\n"
+"Returns recovered data as a bytearray, or an empty list on failure.\n"
+"Damaged codes can give different results from multi_code.multi_code_decode.");
+
+static PyObject* pmc_Decode(PyObject* self, PyObject* args) {
+    PyObject* code;
+    Py_ssize_t dataLength;
+    int correctionSymbols;
+    if (!PyArg_ParseTuple(args, "Oni:multi_code_decode", &code, &dataLength, &correctionSymbols)) return NULL;
+    if (pmc_CheckLengths(dataLength, correctionSymbols) != 0) return NULL;
+
+    char* input     = PyMem_Malloc((size_t)pmc_CodeSpace(code));
+    uint8_t* output = PyMem_Malloc((size_t)dataLength + 1);
+    PyObject* result = NULL;
+    Py_ssize_t used  = 0;
+
+    if (input == NULL || output == NULL) {
+        PyErr_NoMemory();
+    } else if (pmc_ReadCode(code, input, &used) == 0) {
+        MultiCodeStatus status = MultiCode_DecodeInto(input, (int)dataLength, correctionSymbols, output);
+        result = pmc_DecodeResult(output, (int)dataLength, status == MultiCode_Clean || status == MultiCode_Corrected);
+    }
+
+    PyMem_Free(input);
+    PyMem_Free(output);
+    return result;
+}
+
+PyDoc_STRVAR(pmc_encode_batch_doc,
+"multi_code_encode_batch(sources, correction_symbols, source_length=-1, threads=0)\n--\n\n"
+"Encode many payloads of the same length, without holding the GIL.\n"
+"sources: a sequence of bytes-like payloads, or one bytes-like object holding\n"
+"         payloads of 'source_length' bytes back to back\n"
+"correction_symbols: count of correction symbols to add\n"
+"threads: most threads to use, or 0 for one per processor\n"
+"Returns a list of multi-code strings, the same as multi_code_encode for each payload.");
+
+static PyObject* pmc_EncodeBatch(PyObject* self, PyObject* args, PyObject* keywords) {
+    static char* names[] = {"sources", "correction_symbols", "source_length", "threads", NULL};
+    PyObject* sources;
+    int correctionSymbols;
+    Py_ssize_t sourceLength = -1;
+    int threads             = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, keywords, "Oi|ni:multi_code_encode_batch", names,
+                                     &sources, &correctionSymbols, &sourceLength, &threads)) return NULL;
+
+    // Take a copy of every payload, so the GIL can be released
+    Py_buffer packed = {0};
+    PyObject* list   = NULL;
+    Py_ssize_t count;
+    if (PyObject_CheckBuffer(sources) && !PyUnicode_Check(sources)) {
+        if (sourceLength < 1) {
+            PyErr_SetString(PyExc_ValueError, "source_length is needed when sources is a single buffer");
+            return NULL;
+        }
+        if (PyObject_GetBuffer(sources, &packed, PyBUF_SIMPLE) != 0) return NULL;
+        if (packed.len % sourceLength != 0) {
+            PyBuffer_Release(&packed);
+            PyErr_SetString(PyExc_ValueError, "buffer length is not a multiple of source_length");
+            return NULL;
+        }
+        count = packed.len / sourceLength;
+    } else {
+        list = PySequence_Fast(sources, "sources must be a sequence of bytes-like objects, or a buffer");
+        if (list == NULL) return NULL;
+        count = PySequence_Fast_GET_SIZE(list);
+    }
+
+    PyObject* result = NULL;
+    char* copy       = NULL;
+    const void** pointers = NULL;
+    char** encoded   = NULL;
+
+    if (count > INT_MAX || (sourceLength > 0 && count > PY_SSIZE_T_MAX / 2 / sourceLength)) {
+        PyErr_SetString(PyExc_ValueError, "too many payloads in one batch");
+        goto done;
+    }
+
+    // Payloads in a list set the length, and must all match it
+    for (Py_ssize_t i = 0; list != NULL && i < count; i++) {
+        Py_buffer item;
+        if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(list, i), &item, PyBUF_SIMPLE) != 0) goto done;
+        Py_ssize_t length = item.len;
+        PyBuffer_Release(&item);
+        if (sourceLength < 0) sourceLength = length;
+        if (length != sourceLength) {
+            PyErr_SetString(PyExc_ValueError, "every payload in a batch must be the same length");
+            goto done;
+        }
+    }
+    if (sourceLength < 0) sourceLength = 0;
+    if (pmc_CheckLengths(sourceLength, correctionSymbols) != 0) goto done;
+
+    copy     = PyMem_Malloc((size_t)(count * sourceLength) + 1);
+    pointers = PyMem_Calloc((size_t)count + 1, sizeof(void*));
+    encoded  = PyMem_Calloc((size_t)count + 1, sizeof(char*));
+    if (copy == NULL || pointers == NULL || encoded == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    for (Py_ssize_t i = 0; i < count; i++) {
+        char* at = copy + i * sourceLength;
+        if (list == NULL) {
+            memcpy(at, (const char*)packed.buf + i * sourceLength, (size_t)sourceLength);
+        } else {
+            Py_buffer item;
+            if (PyObject_GetBuffer(PySequence_Fast_GET_ITEM(list, i), &item, PyBUF_SIMPLE) != 0) goto done;
+            memcpy(at, item.buf, (size_t)sourceLength);
+            PyBuffer_Release(&item);
+        }
+        pointers[i] = at;
+    }
+
+    pmc_Slice batch = {0, 0, (int)sourceLength, correctionSymbols, NULL, pointers, NULL, NULL, encoded};
+    if (sourceLength > 0) {
+        Py_BEGIN_ALLOW_THREADS
+        pmc_RunBatch(batch, (int)count, threads);
+        Py_END_ALLOW_THREADS
+    }
+
+    result = PyList_New(count);
+    for (Py_ssize_t i = 0; result != NULL && i < count; i++) {
+        PyObject* code = sourceLength == 0 ? pmc_EmptyCode(correctionSymbols)
+                       : encoded[i] == NULL ? PyErr_NoMemory()
+                       : PyUnicode_FromString(encoded[i]);
+        if (code == NULL) Py_CLEAR(result);
+        else PyList_SET_ITEM(result, i, code);
+    }
+
+done:
+    for (Py_ssize_t i = 0; encoded != NULL && i < count; i++) free(encoded[i]);
+    PyMem_Free(encoded);
+    PyMem_Free(pointers);
+    PyMem_Free(copy);
+    if (packed.obj != NULL) PyBuffer_Release(&packed);
+    Py_XDECREF(list);
+    return result;
+}
+
+PyDoc_STRVAR(pmc_decode_batch_doc,
+"multi_code_decode_batch(codes, data_length, correction_symbols, threads=0)\n--\n\n"
+"Decode many multi-code strings with the same data length, without holding the GIL.\n"
+"codes: a sequence of str, or one bytes-like object of ASCII codes, one per line\n"
+"data_length: number of bytes in ORIGINAL data\n"
+"correction_symbols: count of correction symbols added to codes\n"
+"threads: most threads to use, or 0 for one per processor\n"
+"Returns a list with the same results as multi_code_decode for each code.");
+
+static PyObject* pmc_DecodeBatch(PyObject* self, PyObject* args, PyObject* keywords) {
+    static char* names[] = {"codes", "data_length", "correction_symbols", "threads", NULL};
+    PyObject* codes;
+    Py_ssize_t dataLength;
+    int correctionSymbols;
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, keywords, "Oni|i:multi_code_decode_batch", names,
+                                     &codes, &dataLength, &correctionSymbols, &threads)) return NULL;
+    if (pmc_CheckLengths(dataLength, correctionSymbols) != 0) return NULL;
+
+    // Take a copy of every code, null-terminated, so the GIL can be released
+    Py_buffer lines = {0};
+    PyObject* list  = NULL;
+    Py_ssize_t count = 0;
+    Py_ssize_t space = 0;
+    if (PyObject_CheckBuffer(codes) && !PyUnicode_Check(codes)) {
+        if (PyObject_GetBuffer(codes, &lines, PyBUF_SIMPLE) != 0) return NULL;
+        const char* text = lines.buf;
+        for (Py_ssize_t i = 0; i < lines.len; i++) {
+            if (text[i] == '\n') count++;
+        }
+        if (lines.len > 0 && text[lines.len - 1] != '\n') count++;
+        space = lines.len + 1;
+    } else {
+        list = PySequence_Fast(codes, "codes must be a sequence of str, or a buffer of lines");
+        if (list == NULL) return NULL;
+        count = PySequence_Fast_GET_SIZE(list);
+        for (Py_ssize_t i = 0; i < count; i++) space += pmc_CodeSpace(PySequence_Fast_GET_ITEM(list, i));
+    }
+
+    PyObject* result          = NULL;
+    char* copy                = NULL;
+    const char** pointers     = NULL;
+    uint8_t* output           = NULL;
+    MultiCodeStatus* statuses = NULL;
+
+    if (count > INT_MAX || (dataLength > 0 && count > PY_SSIZE_T_MAX / 2 / dataLength)) {
+        PyErr_SetString(PyExc_ValueError, "too many codes in one batch");
+        goto done;
+    }
+
+    copy     = PyMem_Malloc((size_t)space + 1);
+    pointers = PyMem_Calloc((size_t)count + 1, sizeof(char*));
+    output   = PyMem_Malloc((size_t)(count * dataLength) + 1);
+    statuses = PyMem_Calloc((size_t)count + 1, sizeof(MultiCodeStatus));
+    if (copy == NULL || pointers == NULL || output == NULL || statuses == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    Py_ssize_t used = 0;
+    if (list == NULL) {
+        // Split lines, dropping any '\r' before the '\n', and stopping each code at a NUL as str input does
+        const char* text = lines.buf;
+        Py_ssize_t start = 0;
+        for (Py_ssize_t i = 0; i < count; i++) {
+            Py_ssize_t end = start;
+            while (end < lines.len && text[end] != '\n') end++;
+            Py_ssize_t stop = end > start && text[end - 1] == '\r' ? end - 1 : end;
+            pointers[i] = copy + used;
+            memcpy(copy + used, text + start, (size_t)(stop - start));
+            used += stop - start;
+            copy[used++] = 0;
+            start = end + 1;
+        }
+    } else {
+        for (Py_ssize_t i = 0; i < count; i++) {
+            pointers[i] = copy + used;
+            if (pmc_ReadCode(PySequence_Fast_GET_ITEM(list, i), copy, &used) != 0) goto done;
+        }
+    }
+
+    pmc_Slice batch = {0, 0, (int)dataLength, correctionSymbols, pointers, NULL, output, statuses, NULL};
+    Py_BEGIN_ALLOW_THREADS
+    pmc_RunBatch(batch, (int)count, threads);
+    Py_END_ALLOW_THREADS
+
+    result = PyList_New(count);
+    for (Py_ssize_t i = 0; result != NULL && i < count; i++) {
+        int ok = statuses[i] == MultiCode_Clean || statuses[i] == MultiCode_Corrected;
+        PyObject* data = pmc_DecodeResult(output + i * dataLength, (int)dataLength, ok);
+        if (data == NULL) Py_CLEAR(result);
+        else PyList_SET_ITEM(result, i, data);
+    }
+
+done:
+    PyMem_Free(statuses);
+    PyMem_Free(output);
+    PyMem_Free(pointers);
+    PyMem_Free(copy);
+    if (lines.obj != NULL) PyBuffer_Release(&lines);
+    Py_XDECREF(list);
+    return result;
+}
+
+#pragma endregion Functions
+
+static PyMethodDef pmc_methods[] = {
+    {"multi_code_encode", pmc_Encode, METH_VARARGS, pmc_encode_doc},
+    {"multi_code_decode", pmc_Decode, METH_VARARGS, pmc_decode_doc},
+    {"multi_code_encode_batch", (PyCFunction)(void (*)(void))pmc_EncodeBatch, METH_VARARGS | METH_KEYWORDS, pmc_encode_batch_doc},
+    {"multi_code_decode_batch", (PyCFunction)(void (*)(void))pmc_DecodeBatch, METH_VARARGS | METH_KEYWORDS, pmc_decode_batch_doc},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef pmc_module = {
+    PyModuleDef_HEAD_INIT,
+    "_multi_code",
+    "MultiCode encoding and decoding, using the C implementation.\n"
+    "Encoding, and decoding of undamaged codes, give the same results as the multi_code module.\n"
+    "Damaged codes can decode differently. The C decoder repairs more of them, so some codes that\n"
+    "multi_code rejects, or raises IndexError on, decode here, and a few decode to different data.\n"
+    "multi_code does not switch to this module by itself.",
+    -1,
+    pmc_methods
+};
+
+PyMODINIT_FUNC PyInit__multi_code(void) {
+    return PyModule_Create(&pmc_module);
+}
@@ -871,6 +871,10 @@ def multi_code_decode(code:str, data_length:int, correction_symbols:int):
     :param data_length: number of bytes in ORIGINAL data
     :param correction_symbols: count of correction symbols added to code
     :return: recovered data or empty array on failure
+
+    The _multi_code extension gives the same results for undamaged codes, but can decode
+    damaged codes differently: it repairs more of them, and never raises. This function does
+    not switch to the extension when it is built; import _multi_code explicitly to use it.
     """
     expected_code_length = (data_length * 2) + correction_symbols
     clean_input = mc_decode_display(expected_code_length, code)
@@ -0,0 +1,28 @@
+﻿"""
+Build the optional _multi_code extension from the C implementation:
+
+    python3 setup.py build_ext --inplace
+
+Encoding, and decoding of undamaged codes, give the same results as
+multi_code.py. Damaged codes can decode differently, as the C decoder
+repairs more of them. multi_code.py does not switch to the extension by
+itself; import _multi_code explicitly where the C results are wanted.
+"""
+import os
+from setuptools import setup, Extension
+
+C99 = os.path.join('..', '..', 'c99')
+
+setup(
+    name='multi_code',
+    version='1.0',
+    py_modules=['multi_code'],
+    ext_modules=[
+        Extension(
+            '_multi_code',
+            sources=['_multi_code.c'],
+            depends=[os.path.join(C99, 'MultiCode.c'), os.path.join(C99, 'MultiCode.h')],
+            include_dirs=[C99],
+        ),
+    ],
+)